@@ -0,0 +1,334 @@
+#include <array>
+#include <string>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <random>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <x86intrin.h>
+
+#include "search.hpp"
+#include "corpus.hpp"
+#include "dispatch.hpp"
+#include "header_search.hpp"
+
+// 形×ビット幅×盤面×キャッシュの状態ごとに、探索1回の時間とTSCのサイクル数を計測する
+// isa/以下では、命令セットのレベルごとに、探索カーネル(dispatch)と同じ-marchでビルドしたヘッダーの探索(header)を比べる
+// 盤面は手で書いた盤面と、corpus_generatorで作った盤面の種類ごとの一覧を使う
+// corpus_genで書き出した盤面を使うには --corpus=corpus.bin を付ける
+// JSONで保存するには --benchmark_out=result.json --benchmark_out_format=json を付ける
+namespace {
+    struct fixed_board {
+        const char *name;
+        const char *board;
+    };
+
+    constexpr std::array fixed_boards{
+            fixed_board{"empty", ""},
+            fixed_board{
+                    "lemontea",
+                    ""
+                    "X........."
+                    "X........."
+                    "XX......XX"
+                    "XXX....XXX"
+                    "XXXX...XXX"
+                    "XXXX..XXXX"
+                    "XXX...XXXX"
+                    "XXXX.XXXXX"
+            },
+            fixed_board{
+                    "lzt",
+                    ""
+                    "XXXX..XXX."
+                    "XXXXX.XXXX"
+                    "......X..X"
+                    ".........."
+                    "...X......"
+                    "....XX.X.X"
+                    "XXX.X....."
+                    "XX..X....X"
+                    "X....X...."
+                    "XX..XXXX.X"
+                    "X....XX..."
+                    "XX.XXX...."
+                    ".......X.."
+                    "......XXX."
+                    "XX.X......"
+                    "X....X...."
+                    "X...X....X"
+                    "X..XX.X.XX"
+                    "XX..XXXXXX"
+            },
+    };
+
+    enum class Cache {
+        // 同じ盤面(の一覧)を繰り返し探索する
+        Warm,
+        // L3より大きな領域に並べた盤面を、シャッフルした順に探索する
+        Cold,
+    };
+
+    // --corpusを指定しないときに作る盤面
+    constexpr uint64_t DefaultSeed = 1;
+    constexpr size_t DefaultCountPerKind = 16;
+    constexpr std::array<uint8_t, 5> DefaultHeights{4, 8, 12, 16, 20};
+
+    constexpr size_t ColdPoolBytes = 64 << 20;
+
+    // 探索する順番を決めるシード。計測ごとに同じ順番になるよう固定する
+    constexpr uint64_t OrderSeed = 1;
+
+    // 探索1回ごとのサイクル数を記録する上限
+    constexpr size_t MaxSamples = 1 << 20;
+
+    double percentile(std::vector<uint64_t> &samples, const double p) {
+        if (samples.empty()) {
+            return 0;
+        }
+        const auto nth = samples.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(samples.size() - 1));
+        std::nth_element(samples.begin(), nth, samples.end());
+        return static_cast<double>(*nth);
+    }
+
+    // searchを繰り返し呼び、探索1回ごとのTSCのサイクル数から平均と分位点を記録する
+    template<typename F>
+    void run_timed(benchmark::State &state, F &&search) {
+        std::vector<uint64_t> samples;
+        samples.reserve(MaxSamples);
+
+        unsigned int aux;
+        for (auto _: state) {
+            _mm_lfence();
+            const auto start = __rdtsc();
+            auto goals = search();
+            benchmark::DoNotOptimize(goals);
+            const auto end = __rdtscp(&aux);
+            _mm_lfence();
+
+            if (samples.size() < MaxSamples) {
+                samples.push_back(end - start);
+            }
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+        state.counters["cycles"] = samples.empty() ? 0.0 : static_cast<double>(
+                std::accumulate(samples.begin(), samples.end(), uint64_t{0})
+        ) / static_cast<double>(samples.size());
+        state.counters["p50"] = percentile(samples, 0.50);
+        state.counters["p90"] = percentile(samples, 0.90);
+        state.counters["p99"] = percentile(samples, 0.99);
+    }
+
+    template<typename Data, Shape Shape>
+    void bm_search(
+            benchmark::State &state,
+            const std::vector<typename data<Data>::AlignedBoard> &boards,
+            const Cache cache
+    ) {
+        using AlignedBoard = typename data<Data>::AlignedBoard;
+
+        auto pool = boards;
+        if (cache == Cache::Cold) {
+            pool.reserve(ColdPoolBytes / sizeof(AlignedBoard));
+            while (pool.size() < pool.capacity()) {
+                pool.push_back(boards[pool.size() % boards.size()]);
+            }
+        }
+
+        // 一定の歩幅で進むとハードウェアのプリフェッチが追従してしまうため、ランダムな順列をたどる
+        // 結果が処理系で変わらないよう、標準ライブラリの分布は使わずにFisher-Yatesで並べる
+        std::vector<uint32_t> order(pool.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937_64 engine{OrderSeed};
+        for (size_t index = order.size(); 1 < index; --index) {
+            std::swap(order[index - 1], order[engine() % index]);
+        }
+
+        size_t index = 0;
+        run_timed(state, [&]() {
+            const auto &current = pool[order[index]];
+            if (order.size() <= ++index) {
+                index = 0;
+            }
+            return s::searcher<Data, Shape>::search(current, Orientation::North, 4, 20);
+        });
+    }
+
+    // 探索カーネルと、同じ-marchでビルドしたヘッダーの探索
+    enum class Path {
+        Dispatch,
+        Header,
+    };
+
+    const bench_isa::header_kernels &header_kernels_of(const s::IsaLevel level) {
+        switch (level) {
+            case s::IsaLevel::X86_64_V4:
+                return bench_isa::header_v4;
+            case s::IsaLevel::X86_64_V3:
+                return bench_isa::header_v3;
+            default:
+                return bench_isa::header_v2;
+        }
+    }
+
+    template<typename Data>
+    void bm_level(
+            benchmark::State &state,
+            const typename data<Data>::AlignedBoard &board,
+            const Shape shape,
+            const s::IsaLevel level,
+            const Path path
+    ) {
+        const s::Spawn spawn{Orientation::North, 4, 20};
+        const auto header = header_kernels_of(level).template get<Data>();
+
+        const auto dispatch_search = [&]() {
+            return s::dispatch_search<Data>(level, board.columns, shape, spawn);
+        };
+        const auto header_search = [&]() {
+            std::array<Data, 4 * 10> goals{};
+            header(
+                    board.columns.data(), static_cast<uint8_t>(shape), static_cast<uint8_t>(spawn.orientation),
+                    spawn.cx, spawn.cy, goals.data()
+            );
+            return goals;
+        };
+
+        // 速さを比べる前に、同じ結果になることを確かめる
+        if (dispatch_search() != header_search()) {
+            state.SkipWithError("dispatch_search differs from the header search");
+            return;
+        }
+
+        if (path == Path::Dispatch) {
+            run_timed(state, dispatch_search);
+        } else {
+            run_timed(state, header_search);
+        }
+    }
+
+    template<typename Data>
+    void register_boards(const std::string &name, const std::vector<typename data<Data>::AlignedBoard> &boards) {
+        if (boards.empty()) {
+            return;
+        }
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            for (const auto cache: {Cache::Warm, Cache::Cold}) {
+                const auto full_name = name + "/" + "TIOLJSZ"[static_cast<int>(Shape)]
+                                       + (cache == Cache::Warm ? "/warm" : "/cold");
+                benchmark::RegisterBenchmark(full_name.c_str(), [boards, cache](benchmark::State &state) {
+                    bm_search<Data, Shape>(state, boards, cache);
+                });
+            }
+        });
+    }
+
+    // このCPUで使えるレベルごとに、探索カーネルとヘッダーの探索を並べて登録する
+    template<typename Data>
+    void register_levels(
+            const std::string &prefix,
+            const std::string &name,
+            const typename data<Data>::AlignedBoard &board
+    ) {
+        for (const auto level: s::all_isa_levels) {
+            if (!s::is_supported(level)) {
+                continue;
+            }
+            for (const auto shape: {Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}) {
+                for (const auto path: {Path::Dispatch, Path::Header}) {
+                    const auto full_name = prefix + s::isa_level_name(level) + "/" + name + "/"
+                                           + "TIOLJSZ"[static_cast<int>(shape)]
+                                           + (path == Path::Dispatch ? "/dispatch" : "/header");
+                    benchmark::RegisterBenchmark(full_name.c_str(), [board, shape, level, path](benchmark::State &state) {
+                        bm_level<Data>(state, board, shape, level, path);
+                    });
+                }
+            }
+        }
+    }
+
+    template<typename Data>
+    void register_all(const std::string &width, const std::vector<s::CorpusBoard> &corpus_boards) {
+        for (const auto &entry: fixed_boards) {
+            // 盤面の高さがDataに収まらない場合は計測しない
+            const auto board_t = data<Data>::from_str(entry.board);
+            if (!board_t) {
+                continue;
+            }
+            typename data<Data>::AlignedBoard board{};
+            board_t->copy_to(board.columns.data(), stdx::vector_aligned);
+            register_boards<Data>("search/" + width + "/" + entry.name, {board});
+            register_levels<Data>("isa/", width + "/" + entry.name, board);
+        }
+
+        // 種類ごとに、Dataに収まるすべての盤面を順に探索する
+        for (const auto kind: s::all_board_kinds) {
+            std::vector<typename data<Data>::AlignedBoard> boards;
+            for (const auto &corpus_board: corpus_boards) {
+                if (corpus_board.kind != kind) {
+                    continue;
+                }
+                if (const auto board = corpus_board.template to_aligned<Data>()) {
+                    boards.push_back(*board);
+                }
+            }
+            register_boards<Data>("corpus/" + width + "/" + s::board_kind_name(kind), boards);
+        }
+    }
+
+    // --corpus=<path>を取り除いて、そのパスを返す
+    std::optional<std::string> take_corpus_path(int &argc, char **argv) {
+        constexpr std::string_view prefix = "--corpus=";
+        std::optional<std::string> path;
+        int out = 1;
+        for (int index = 1; index < argc; ++index) {
+            const std::string_view arg = argv[index];
+            if (arg.starts_with(prefix)) {
+                path = std::string(arg.substr(prefix.size()));
+            } else {
+                argv[out++] = argv[index];
+            }
+        }
+        argc = out;
+        return path;
+    }
+}
+
+int main(int argc, char **argv) {
+    const auto corpus_path = take_corpus_path(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    std::vector<s::CorpusBoard> corpus_boards;
+    if (corpus_path) {
+        std::ifstream in(*corpus_path, std::ios::binary);
+        auto loaded = s::read_corpus(in);
+        if (!loaded) {
+            std::cerr << "failed to read " << *corpus_path << std::endl;
+            return 1;
+        }
+        corpus_boards = std::move(*loaded);
+    } else {
+        auto generator = s::corpus_generator{DefaultSeed};
+        corpus_boards = generator.generate(DefaultCountPerKind, DefaultHeights);
+    }
+
+    // 結果を比べるときに、ビルドした命令セットが分かるように
+    benchmark::AddCustomContext("lane_shift", backend_name(NativeBackend));
+
+    register_all<uint8_t>("u8", corpus_boards);
+    register_all<uint16_t>("u16", corpus_boards);
+    register_all<uint32_t>("u32", corpus_boards);
+    register_all<uint64_t>("u64", corpus_boards);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+
+// 盤面の一覧を作って、ファイルに書き出す
+// corpus_gen <output> [seed] [count per kind] [height...]
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <output> [seed] [count per kind] [height...]" << std::endl;
+        return 1;
+    }
+
+    const auto seed = 2 < argc ? std::stoull(argv[2]) : 1;
+    const auto count = 3 < argc ? std::stoull(argv[3]) : 64;
+
+    std::vector<uint8_t> heights;
+    for (int index = 4; index < argc; ++index) {
+        const auto height = std::stoul(argv[index]);
+        if (height == 0 || s::corpus_generator::MaxHeight < height) {
+            std::cerr << "height must be in [1, " << static_cast<int>(s::corpus_generator::MaxHeight) << "]"
+                    << std::endl;
+            return 1;
+        }
+        heights.push_back(static_cast<uint8_t>(height));
+    }
+    if (heights.empty()) {
+        heights = {4, 8, 12, 16, 20};
+    }
+
+    auto generator = s::corpus_generator{seed};
+    const auto boards = generator.generate(count, heights);
+
+    std::ofstream out(argv[1], std::ios::binary);
+    s::write_corpus(out, boards);
+    if (!out) {
+        std::cerr << "failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << boards.size() << " boards (seed=" << seed << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,34 @@
+// ヘッダーの探索を、BENCH_HEADER_KERNELSで指定した名前(header_v2など)でビルドする
+// bitrisの探索カーネルと同じく、レベルごとに名前空間を分けて、他のレベルの実体と混ざらないようにする
+#define BITRIS_ABI_CONCAT_(a, b) a##b
+#define BITRIS_ABI_CONCAT(a, b) BITRIS_ABI_CONCAT_(a, b)
+#define BITRIS_ABI BITRIS_ABI_CONCAT(BENCH_HEADER_KERNELS, _impl)
+
+#include <algorithm>
+#include <cstdint>
+
+#include "search.hpp"
+#include "header_search.hpp"
+
+namespace {
+    template<typename Data>
+    void search(
+            const Data *columns,
+            const uint8_t shape,
+            const uint8_t orientation,
+            const uint8_t cx,
+            const uint8_t cy,
+            Data *out
+    ) {
+        typename data<Data>::AlignedBoard board;
+        std::copy_n(columns, 10, board.columns.begin());
+
+        const auto spawn = s::Spawn{static_cast<Orientation>(orientation), cx, cy};
+        const auto result = s::search_shape<Data>(board, static_cast<Shape>(shape), spawn);
+        std::copy(result.begin(), result.end(), out);
+    }
+}
+
+const bench_isa::header_kernels bench_isa::BENCH_HEADER_KERNELS{
+        search<uint8_t>, search<uint16_t>, search<uint32_t>, search<uint64_t>,
+};
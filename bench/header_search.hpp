@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// ヘッダーのs::search_shapeを、探索カーネルと同じ-march=x86-64-v2などでビルドしたもの (header_search.cpp)
+// 探索カーネル(s::dispatch_search)と同じ形の関数にして、同じ命令セットのヘッダーの探索と比べる
+namespace bench_isa {
+    // columnsは盤面の10列、outは向き×10列
+    template<typename Data>
+    using search_fn = void (*)(
+            const Data *columns, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, Data *out
+    );
+
+    struct header_kernels {
+        search_fn<uint8_t> u8;
+        search_fn<uint16_t> u16;
+        search_fn<uint32_t> u32;
+        search_fn<uint64_t> u64;
+
+        template<typename Data>
+        [[nodiscard]] search_fn<Data> get() const {
+            if constexpr (std::is_same_v<Data, uint8_t>) {
+                return u8;
+            } else if constexpr (std::is_same_v<Data, uint16_t>) {
+                return u16;
+            } else if constexpr (std::is_same_v<Data, uint32_t>) {
+                return u32;
+            } else {
+                static_assert(std::is_same_v<Data, uint64_t>);
+                return u64;
+            }
+        }
+    };
+
+    extern const header_kernels header_v2;
+    extern const header_kernels header_v3;
+    extern const header_kernels header_v4;
+}
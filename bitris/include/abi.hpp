@@ -0,0 +1,11 @@
+#pragma once
+
+// ヘッダーの宣言はすべて、BITRIS_ABIという名前のインライン名前空間に入れる
+// 命令セットのレベルごとにビルドする探索カーネル(src/search_kernels.cpp)では、レベルごとに別の名前を指定する
+// テンプレートの実体のシンボル名がレベルごとに変わるため、他のレベルの実体とリンク時に混ざらない
+#ifndef BITRIS_ABI
+#define BITRIS_ABI bitris_native
+#endif
+
+#define BITRIS_ABI_BEGIN inline namespace BITRIS_ABI {
+#define BITRIS_ABI_END }
@@ -0,0 +1,73 @@
+#ifndef BITRIS_H
+#define BITRIS_H
+
+/*
+ * bitrisライブラリのC API
+ * 探索は、起動時にCPUに合わせて選んだ命令セットのカーネルで行う (dispatch.hpp)
+ *
+ * 盤面は10列で、列ごとに下の段から順にビットを並べる (bit y が y 段目)
+ * 結果は向き×10列の40要素で、向きはNorth, East, South, Westの順。Oは先頭の10列のみを使い、残りは0になる
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* shapeの値 */
+enum {
+    BITRIS_SHAPE_T = 0,
+    BITRIS_SHAPE_I = 1,
+    BITRIS_SHAPE_O = 2,
+    BITRIS_SHAPE_L = 3,
+    BITRIS_SHAPE_J = 4,
+    BITRIS_SHAPE_S = 5,
+    BITRIS_SHAPE_Z = 6,
+};
+
+/* orientationの値 */
+enum {
+    BITRIS_ORIENTATION_NORTH = 0,
+    BITRIS_ORIENTATION_EAST = 1,
+    BITRIS_ORIENTATION_SOUTH = 2,
+    BITRIS_ORIENTATION_WEST = 3,
+};
+
+/* 戻り値 */
+enum {
+    BITRIS_OK = 0,
+    BITRIS_ERROR_INVALID_ARGUMENT = -1,
+};
+
+typedef struct bitris_spawn {
+    uint8_t orientation;
+    uint8_t cx;
+    uint8_t cy;
+} bitris_spawn;
+
+/* 選ばれた命令セットの名前 ("x86-64-v3"など) */
+const char *bitris_isa_level(void);
+
+/* boardは10要素、outは40要素 */
+int bitris_search_u8(const uint8_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint8_t *out);
+int bitris_search_u16(const uint16_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint16_t *out);
+int bitris_search_u32(const uint32_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint32_t *out);
+int bitris_search_u64(const uint64_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint64_t *out);
+
+/*
+ * count個の盤面を同じshapeで探索する
+ * boardsは10×count要素、spawnsはcount要素、outは40×count要素
+ * 引数が不正な場合は、何も書き出さずにBITRIS_ERROR_INVALID_ARGUMENTを返す
+ */
+int bitris_search_batch_u8(const uint8_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint8_t *out);
+int bitris_search_batch_u16(const uint16_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint16_t *out);
+int bitris_search_batch_u32(const uint32_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint32_t *out);
+int bitris_search_batch_u64(const uint64_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint64_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
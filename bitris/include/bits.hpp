@@ -1,7 +1,21 @@
 #pragma once
 
+#include <bit>
+#include <limits>
+#include <cstdint>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "abi.hpp"
 #include "templates.hpp"
 
+BITRIS_ABI_BEGIN
+
+// 64段を超える盤面で使う。std::experimental::simdで扱うにはGNU拡張(-std=gnu++23)が必要
+using uint128_t = unsigned __int128;
+
 template<typename Data>
 struct bits {
     static constexpr Data zero = 0;
@@ -21,11 +35,46 @@ struct bits {
 
     [[gnu::always_inline]]
     static constexpr int most_significant_index(const Data v) {
-        [[assume(bit_size <= 64)]];
+        static_assert(bit_size <= 128);
         if constexpr (bit_size <= 32) {
             return 0 < v ? 31 - __builtin_clz(v) : -1;
-        } else {
+        } else if constexpr (bit_size <= 64) {
             return 0 < v ? 63 - __builtin_clzll(v) : -1;
+        } else {
+            const auto high = static_cast<uint64_t>(v >> 64);
+            if (0 < high) {
+                return 127 - __builtin_clzll(high);
+            }
+            return bits<uint64_t>::most_significant_index(static_cast<uint64_t>(v));
+        }
+    }
+
+    // maskで1が立っている位置のビットを取り出し、下位に詰める (pext)
+    [[gnu::always_inline]]
+    static inline Data extract(const Data v, const Data mask) {
+#ifdef __BMI2__
+        if constexpr (bit_size <= 32) {
+            return static_cast<Data>(_pext_u32(v, mask));
+        } else if constexpr (bit_size <= 64) {
+            return static_cast<Data>(_pext_u64(v, mask));
+        } else {
+            const auto low_mask = static_cast<uint64_t>(mask);
+            const auto low = _pext_u64(static_cast<uint64_t>(v), low_mask);
+            const auto high = _pext_u64(static_cast<uint64_t>(v >> 64), static_cast<uint64_t>(mask >> 64));
+            return static_cast<Data>(low) | (static_cast<Data>(high) << std::popcount(low_mask));
+        }
+#else
+        Data result = zero;
+        Data bit = one;
+        for (Data m = mask; m; m &= m - 1) {
+            if (v & m & -m) {
+                result |= bit;
+            }
+            bit <<= 1;
         }
+        return result;
+#endif
     }
 };
+
+BITRIS_ABI_END
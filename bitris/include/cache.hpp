@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstring>
+
+#include "abi.hpp"
+#include "search.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // 盤面・形・spawnをキーに、探索結果を保存する固定サイズのキャッシュ
+    // オープンアドレス法で、ハッシュの位置から ProbeLength 個のエントリを調べる
+    // 各エントリはバージョン番号で読み書きを検出するため、ロックなしで複数のスレッドから使える
+    // 書き込みが衝突した場合は、保存をあきらめる
+    template<typename Data, bool Canonical = false>
+    class search_cache {
+    public:
+        using AlignedBoard = typename data<Data>::AlignedBoard;
+        using result_t = std::array<Data, 4 * 10>;
+
+        // スレッド間で共有する変数は、別々のキャッシュラインに置く
+        static constexpr size_t CacheLineSize = 64;
+
+        // 1つのキーについて調べるエントリの数
+        static constexpr size_t ProbeLength = 4;
+
+        // capacityは2のべき乗に切り上げる
+        explicit search_cache(const size_t capacity)
+            : entries_(std::bit_ceil(std::max(capacity, ProbeLength))) {
+        }
+
+        search_cache(const search_cache &) = delete;
+
+        search_cache &operator=(const search_cache &) = delete;
+
+        [[nodiscard]] size_t capacity() const {
+            return entries_.size();
+        }
+
+        [[nodiscard]] size_t hits() const {
+            return hits_.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t misses() const {
+            return misses_.load(std::memory_order_relaxed);
+        }
+
+        // キャッシュにあればその結果を、なければ探索して保存した結果を返す
+        result_t search(const AlignedBoard &board, const Shape shape, const Spawn &spawn) {
+            result_t result;
+            if (find(board, shape, spawn, result)) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return result;
+            }
+
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            result = search_shape<Data, Canonical>(board, shape, spawn);
+            store(board, shape, spawn, result);
+            return result;
+        }
+
+        // 見つかった場合はoutに書き出してtrueを返す。ヒット・ミスの回数は数えない
+        bool find(const AlignedBoard &board, const Shape shape, const Spawn &spawn, result_t &out) const {
+            const auto key = make_key(board, shape, spawn);
+            const auto h = hash(key);
+            for (size_t probe = 0; probe < ProbeLength; ++probe) {
+                const auto &entry = entries_[(h + probe) & (entries_.size() - 1)];
+
+                const auto version = entry.version.load(std::memory_order_acquire);
+                if (version & 1 || entry.hash.load(std::memory_order_relaxed) != h) {
+                    continue;
+                }
+
+                std::array<uint64_t, Words> words;
+                for (size_t index = 0; index < Words; ++index) {
+                    words[index] = entry.words[index].load(std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (entry.version.load(std::memory_order_relaxed) != version) {
+                    continue;
+                }
+
+                if (std::memcmp(words.data(), &key, sizeof(key)) != 0) {
+                    continue;
+                }
+
+                std::memcpy(out.data(), reinterpret_cast<const std::byte *>(words.data()) + sizeof(key), sizeof(out));
+                return true;
+            }
+            return false;
+        }
+
+        // 空いているエントリ、同じキーのエントリ、どちらもなければ先頭のエントリの順に書き込む
+        void store(const AlignedBoard &board, const Shape shape, const Spawn &spawn, const result_t &result) {
+            const auto key = make_key(board, shape, spawn);
+            const auto h = hash(key);
+
+            auto *target = &entries_[h & (entries_.size() - 1)];
+            for (size_t probe = 0; probe < ProbeLength; ++probe) {
+                auto &entry = entries_[(h + probe) & (entries_.size() - 1)];
+                const auto entry_hash = entry.hash.load(std::memory_order_relaxed);
+                if (entry_hash == 0 || entry_hash == h) {
+                    target = &entry;
+                    break;
+                }
+            }
+
+            auto version = target->version.load(std::memory_order_relaxed);
+            if (version & 1 || !target->version.compare_exchange_strong(
+                    version, version + 1, std::memory_order_acquire, std::memory_order_relaxed
+            )) {
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::array<uint64_t, Words> words{};
+            std::memcpy(words.data(), &key, sizeof(key));
+            std::memcpy(reinterpret_cast<std::byte *>(words.data()) + sizeof(key), result.data(), sizeof(result));
+
+            target->hash.store(h, std::memory_order_relaxed);
+            for (size_t index = 0; index < Words; ++index) {
+                target->words[index].store(words[index], std::memory_order_relaxed);
+            }
+            target->version.store(version + 2, std::memory_order_release);
+        }
+
+        // 保存した結果とカウンタを消す。他のスレッドが使っていないときに呼ぶ
+        void clear() {
+            for (auto &entry: entries_) {
+                entry.hash.store(0, std::memory_order_relaxed);
+            }
+            hits_.store(0, std::memory_order_relaxed);
+            misses_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        struct key_t {
+            std::array<Data, 10> columns;
+            uint8_t shape;
+            uint8_t orientation;
+            uint8_t cx;
+            uint8_t cy;
+        };
+
+        static constexpr size_t Words = (sizeof(key_t) + sizeof(result_t) + 7) / 8;
+
+        struct alignas(CacheLineSize) entry_t {
+            std::atomic<uint64_t> version{0};
+            // 0は空きを表す
+            std::atomic<uint64_t> hash{0};
+            std::array<std::atomic<uint64_t>, Words> words{};
+        };
+
+        std::vector<entry_t> entries_;
+
+        alignas(CacheLineSize) std::atomic<size_t> hits_{0};
+        alignas(CacheLineSize) std::atomic<size_t> misses_{0};
+
+        static key_t make_key(const AlignedBoard &board, const Shape shape, const Spawn &spawn) {
+            // パディングも含めてmemcmpで比べるため、0で埋めておく
+            key_t key;
+            std::memset(&key, 0, sizeof(key));
+            key.columns = board.columns;
+            key.shape = static_cast<uint8_t>(shape);
+            key.orientation = static_cast<uint8_t>(spawn.orientation);
+            key.cx = spawn.cx;
+            key.cy = spawn.cy;
+            return key;
+        }
+
+        // 0は空のスロットを表すため、ハッシュは奇数にする
+        static uint64_t hash(const key_t &key) {
+            const uint64_t seed = static_cast<uint64_t>(key.shape) << 24 | static_cast<uint64_t>(key.orientation) << 16
+                                  | static_cast<uint64_t>(key.cx) << 8 | key.cy;
+            return data<Data>::hash(key.columns, seed) | 1;
+        }
+    };
+}
+
+BITRIS_ABI_END
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "data.hpp"
+#include "free_spaces.hpp"
+
+BITRIS_ABI_BEGIN
+
+// S, Z, IはSouth/WestがNorth/Eastと同じブロックを占める
+// (free_spacesでSouth/WestをNorth/Eastのシフトから求めているのと同じ関係)
+template<typename Data, Shape Shape>
+struct canonical {
+    using data_t = data<Data>;
+    using type = typename data_t::type;
+    static constexpr size_t N = free_spaces<Data, Shape>::N;
+
+    static constexpr bool has_duplicates = Shape == Shape::S || Shape == Shape::Z || Shape == Shape::I;
+
+    // South/Westのgoalを、同じブロックを占めるNorth/Eastのgoalに移す
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> fold(const std::array<type, N> &all_goal) {
+        if constexpr (!has_duplicates) {
+            return all_goal;
+        } else {
+            constexpr auto north = static_cast<size_t>(Orientation::North);
+            constexpr auto east = static_cast<size_t>(Orientation::East);
+            constexpr auto south = static_cast<size_t>(Orientation::South);
+            constexpr auto west = static_cast<size_t>(Orientation::West);
+
+            std::array<type, N> folded{};
+            if constexpr (Shape == Shape::I) {
+                // South(x, y) == North(x - 1, y), West(x, y) == East(x, y + 1)
+                folded[north] = all_goal[north] | data_t::template shift_left<1>(all_goal[south]);
+                folded[east] = all_goal[east] | data_t::template shift_up<1>(all_goal[west]);
+            } else {
+                // South(x, y) == North(x, y - 1), West(x, y) == East(x - 1, y)
+                folded[north] = all_goal[north] | data_t::template shift_down<1>(all_goal[south]);
+                folded[east] = all_goal[east] | data_t::template shift_left<1>(all_goal[west]);
+            }
+            folded[south] = data_t::make_zero();
+            folded[west] = data_t::make_zero();
+            return folded;
+        }
+    }
+};
+
+BITRIS_ABI_END
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "kicks.hpp"
+
+BITRIS_ABI_BEGIN
+
+// 回転中心からみた、ミノを構成するブロックの位置
+// free_spacesの各向きと同じ基準で定義する
+template<Shape Shape>
+struct cells {
+    static constexpr size_t N = 4;
+
+    template<Orientation Orientation>
+    static consteval std::array<Offset, N> get() {
+        switch (Shape) {
+            case Shape::T:
+                switch (Orientation) {
+                    case Orientation::North:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {0, 1}};
+                    case Orientation::East:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {1, 0}};
+                    case Orientation::South:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {0, -1}};
+                    case Orientation::West:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {-1, 0}};
+                }
+                break;
+            case Shape::I:
+                switch (Orientation) {
+                    case Orientation::North:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {2, 0}};
+                    case Orientation::East:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {0, -2}};
+                    case Orientation::South:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {-2, 0}};
+                    case Orientation::West:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {0, 2}};
+                }
+                break;
+            case Shape::O:
+                // Oは向きによらず同じ形になるため、North以外も同じ位置を返す
+                return {Offset{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+            case Shape::L:
+                switch (Orientation) {
+                    case Orientation::North:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {1, 1}};
+                    case Orientation::East:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {1, -1}};
+                    case Orientation::South:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {-1, -1}};
+                    case Orientation::West:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {-1, 1}};
+                }
+                break;
+            case Shape::J:
+                switch (Orientation) {
+                    case Orientation::North:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {-1, 1}};
+                    case Orientation::East:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {1, 1}};
+                    case Orientation::South:
+                        return {Offset{0, 0}, {-1, 0}, {1, 0}, {1, -1}};
+                    case Orientation::West:
+                        return {Offset{0, 0}, {0, 1}, {0, -1}, {-1, -1}};
+                }
+                break;
+            case Shape::S:
+                switch (Orientation) {
+                    case Orientation::North:
+                        return {Offset{0, 0}, {-1, 0}, {0, 1}, {1, 1}};
+                    case Orientation::East:
+                        return {Offset{0, 0}, {0, 1}, {1, 0}, {1, -1}};
+                    case Orientation::South:
+                        return {Offset{0, 0}, {1, 0}, {0, -1}, {-1, -1}};
+                    case Orientation::West:
+                        return {Offset{0, 0}, {0, -1}, {-1, 0}, {-1, 1}};
+                }
+                break;
+            case Shape::Z:
+                switch (Orientation) {
+                    case Orientation::North:
+                        return {Offset{0, 0}, {1, 0}, {0, 1}, {-1, 1}};
+                    case Orientation::East:
+                        return {Offset{0, 0}, {0, -1}, {1, 0}, {1, 1}};
+                    case Orientation::South:
+                        return {Offset{0, 0}, {-1, 0}, {0, -1}, {1, -1}};
+                    case Orientation::West:
+                        return {Offset{0, 0}, {0, 1}, {-1, 0}, {-1, -1}};
+                }
+                break;
+        }
+        std::unreachable();
+    }
+
+    static consteval std::array<std::array<Offset, N>, 4> get_all() {
+        return {
+                get<Orientation::North>(),
+                get<Orientation::East>(),
+                get<Orientation::South>(),
+                get<Orientation::West>(),
+        };
+    }
+};
+
+BITRIS_ABI_END
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <bit>
+#include <array>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <span>
+#include <istream>
+#include <ostream>
+#include <optional>
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "cells.hpp"
+#include "data.hpp"
+#include "search.hpp"
+
+BITRIS_ABI_BEGIN
+
+// ベンチマークとテストに使う盤面を、シードから決まった順に作る
+// 盤面はuint64_tの10列で持ち、使うときにDataの盤面に変換する
+namespace s {
+    enum class BoardKind : uint8_t {
+        // ランダムなミノを、ランダムな位置にハードドロップで積む
+        Stack = 0,
+        // 穴の列がときどき変わるせり上がりの上に、ミノを積む
+        Garbage = 1,
+        // すべての行で穴の列が変わるせり上がり
+        Cheese = 2,
+        // 高さの違う列に、空洞と屋根を開ける
+        Tower = 3,
+    };
+
+    constexpr std::array<BoardKind, 4> all_board_kinds{
+            BoardKind::Stack, BoardKind::Garbage, BoardKind::Cheese, BoardKind::Tower,
+    };
+
+    constexpr const char *board_kind_name(const BoardKind kind) {
+        switch (kind) {
+            case BoardKind::Stack:
+                return "stack";
+            case BoardKind::Garbage:
+                return "garbage";
+            case BoardKind::Cheese:
+                return "cheese";
+            default:
+                return "tower";
+        }
+    }
+
+    struct CorpusBoard {
+        BoardKind kind;
+        // 作るときに指定した高さ。すべての列がこの高さ以下になる
+        uint8_t height;
+        std::array<uint64_t, 10> columns;
+
+        constexpr bool operator==(const CorpusBoard &) const = default;
+
+        // 積まれたブロックがDataに収まらない場合はnullopt
+        template<typename Data>
+        [[nodiscard]] std::optional<typename data<Data>::AlignedBoard> to_aligned() const {
+            typename data<Data>::AlignedBoard board{};
+            for (size_t x = 0; x < 10; ++x) {
+                if (bits<Data>::bit_size < static_cast<size_t>(std::bit_width(columns[x]))) {
+                    return std::nullopt;
+                }
+                board.columns[x] = static_cast<Data>(columns[x]);
+            }
+            return board;
+        }
+    };
+
+    class corpus_generator {
+    public:
+        static constexpr uint8_t MaxHeight = 64;
+
+        explicit corpus_generator(const uint64_t seed) : state_(seed) {
+        }
+
+        // heightは1以上MaxHeight以下
+        CorpusBoard generate(const BoardKind kind, const uint8_t height) {
+            assert(0 < height && height <= MaxHeight);
+
+            std::array<uint64_t, 10> columns{};
+            switch (kind) {
+                case BoardKind::Stack:
+                    stack(columns, height);
+                    break;
+                case BoardKind::Garbage:
+                    garbage(columns, height);
+                    break;
+                case BoardKind::Cheese:
+                    cheese(columns, height);
+                    break;
+                case BoardKind::Tower:
+                    tower(columns, height);
+                    break;
+            }
+            clear_lines(columns);
+            return {kind, height, columns};
+        }
+
+        // 種類×高さごとに、count_per_kind枚ずつ作る
+        std::vector<CorpusBoard> generate(const size_t count_per_kind, const std::span<const uint8_t> heights) {
+            std::vector<CorpusBoard> boards;
+            boards.reserve(all_board_kinds.size() * heights.size() * count_per_kind);
+            for (const auto kind: all_board_kinds) {
+                for (const auto height: heights) {
+                    for (size_t index = 0; index < count_per_kind; ++index) {
+                        boards.push_back(generate(kind, height));
+                    }
+                }
+            }
+            return boards;
+        }
+
+    private:
+        uint64_t state_;
+
+        // splitmix64。標準ライブラリの分布は処理系で結果が変わるため使わない
+        uint64_t next() {
+            auto z = (state_ += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        // [0, n)
+        uint64_t below(const uint64_t n) {
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+        }
+
+        // numerator / denominator の確率でtrue
+        bool chance(const uint64_t numerator, const uint64_t denominator) {
+            return below(denominator) < numerator;
+        }
+
+        static uint64_t row_mask(const uint8_t height) {
+            return height < 64 ? (uint64_t{1} << height) - 1 : ~uint64_t{0};
+        }
+
+        // ランダムなミノを1つハードドロップする。heightを超える場合は置かずにfalseを返す
+        bool drop(std::array<uint64_t, 10> &columns, const uint8_t height) {
+            const auto shape = static_cast<Shape>(below(7));
+            const auto orientation = static_cast<Orientation>(below(4));
+            return dispatch_shape(shape, [&]<Shape Shape>() {
+                constexpr auto all_cells = cells<Shape>::get_all();
+                const auto &piece_cells = all_cells[static_cast<size_t>(orientation)];
+
+                int min_x = 0;
+                int max_x = 0;
+                for (const auto &cell: piece_cells) {
+                    min_x = std::min(min_x, cell.x);
+                    max_x = std::max(max_x, cell.x);
+                }
+                const auto x = -min_x + static_cast<int>(below(10 - (max_x - min_x)));
+
+                // 各ブロックの列の高さから、着地する位置を求める
+                int y = 0;
+                for (const auto &cell: piece_cells) {
+                    y = std::max(y, static_cast<int>(std::bit_width(columns[x + cell.x])) - cell.y);
+                }
+
+                for (const auto &cell: piece_cells) {
+                    if (height <= y + cell.y) {
+                        return false;
+                    }
+                }
+                for (const auto &cell: piece_cells) {
+                    columns[x + cell.x] |= uint64_t{1} << (y + cell.y);
+                }
+                return true;
+            });
+        }
+
+        // 置けなくなるまで積み、揃った行は消す
+        void drop_until(std::array<uint64_t, 10> &columns, const uint8_t height) {
+            // 置けないミノが続いたら終える。揃った行が消え続けても終わるよう、回数にも上限を設ける
+            for (size_t failures = 0, attempts = 0; failures < 8 && attempts < 1000; ++attempts) {
+                if (drop(columns, height)) {
+                    clear_lines(columns);
+                    failures = 0;
+                } else {
+                    ++failures;
+                }
+            }
+        }
+
+        // y行目を、holeの列を除いて埋める
+        static void garbage_row(std::array<uint64_t, 10> &columns, const uint8_t y, const size_t hole) {
+            for (size_t x = 0; x < 10; ++x) {
+                if (x != hole) {
+                    columns[x] |= uint64_t{1} << y;
+                }
+            }
+        }
+
+        void stack(std::array<uint64_t, 10> &columns, const uint8_t height) {
+            drop_until(columns, height);
+        }
+
+        void garbage(std::array<uint64_t, 10> &columns, const uint8_t height) {
+            // 高さの1/4から3/4をせり上がりにする
+            const auto rows = static_cast<uint8_t>(height / 4 + below(height / 2 + 1));
+            auto hole = below(10);
+            for (uint8_t y = 0; y < rows; ++y) {
+                if (chance(3, 10)) {
+                    hole = below(10);
+                }
+                garbage_row(columns, y, hole);
+            }
+
+            // 上に積んだミノで揃った行を消すと、せり上がりも下がる
+            drop_until(columns, height);
+        }
+
+        void cheese(std::array<uint64_t, 10> &columns, const uint8_t height) {
+            auto hole = below(10);
+            for (uint8_t y = 0; y < height; ++y) {
+                // 同じ列が続かないように、穴をずらす
+                hole = (hole + 1 + below(9)) % 10;
+                garbage_row(columns, y, hole);
+
+                // ときどき2つ目の穴を開ける
+                if (chance(1, 4)) {
+                    columns[below(10)] &= ~(uint64_t{1} << y);
+                }
+            }
+        }
+
+        void tower(std::array<uint64_t, 10> &columns, const uint8_t height) {
+            for (auto &column: columns) {
+                const auto top = static_cast<uint8_t>(below(height + 1));
+                column = row_mask(top);
+
+                // 一番上のブロックを残して、その下に空洞を開ける
+                if (2 < top && chance(2, 3)) {
+                    const auto length = 1 + below(std::min<uint64_t>(3, top - 2));
+                    const auto bottom = below(top - 1 - length);
+                    column &= ~(row_mask(static_cast<uint8_t>(length)) << bottom);
+                }
+            }
+
+            // 屋根を作るため、隣の列より高い位置に横向きのブロックを張り出させる
+            for (size_t x = 0; x + 1 < 10; ++x) {
+                const auto left = std::bit_width(columns[x]);
+                const auto right = std::bit_width(columns[x + 1]);
+                if (left != right && chance(1, 2)) {
+                    const auto y = std::max(left, right) - 1;
+                    columns[x] |= uint64_t{1} << y;
+                    columns[x + 1] |= uint64_t{1} << y;
+                }
+            }
+        }
+
+        static void clear_lines(std::array<uint64_t, 10> &columns) {
+            uint64_t filled = ~uint64_t{0};
+            for (const auto column: columns) {
+                filled &= column;
+            }
+            if (filled == 0) {
+                return;
+            }
+            for (auto &column: columns) {
+                column = bits<uint64_t>::extract(column, ~filled);
+            }
+        }
+    };
+
+    // 盤面の一覧を、次の形式で書き出す (整数はリトルエンディアン)
+    //   "BTRC", version(u8), count(u32)
+    //   盤面ごとに kind(u8), height(u8), 10列 × ceil(height / 8) バイト
+    constexpr std::array<char, 4> CorpusMagic{'B', 'T', 'R', 'C'};
+    constexpr uint8_t CorpusVersion = 1;
+
+    inline void write_corpus(std::ostream &out, const std::span<const CorpusBoard> boards) {
+        const auto put = [&](const uint64_t value, const size_t bytes) {
+            for (size_t index = 0; index < bytes; ++index) {
+                out.put(static_cast<char>(value >> (8 * index)));
+            }
+        };
+
+        out.write(CorpusMagic.data(), CorpusMagic.size());
+        put(CorpusVersion, 1);
+        put(boards.size(), 4);
+        for (const auto &board: boards) {
+            put(static_cast<uint8_t>(board.kind), 1);
+            put(board.height, 1);
+            const auto bytes = (board.height + 7) / 8;
+            for (const auto column: board.columns) {
+                put(column, bytes);
+            }
+        }
+    }
+
+    // 形式が正しくない場合はnullopt
+    inline std::optional<std::vector<CorpusBoard> > read_corpus(std::istream &in) {
+        const auto get = [&](const size_t bytes) -> std::optional<uint64_t> {
+            uint64_t value = 0;
+            for (size_t index = 0; index < bytes; ++index) {
+                const auto ch = in.get();
+                if (ch == std::istream::traits_type::eof()) {
+                    return std::nullopt;
+                }
+                value |= static_cast<uint64_t>(static_cast<uint8_t>(ch)) << (8 * index);
+            }
+            return value;
+        };
+
+        std::array<char, 4> magic{};
+        if (!in.read(magic.data(), magic.size()) || magic != CorpusMagic) {
+            return std::nullopt;
+        }
+        if (get(1) != CorpusVersion) {
+            return std::nullopt;
+        }
+        const auto count = get(4);
+        if (!count) {
+            return std::nullopt;
+        }
+
+        std::vector<CorpusBoard> boards;
+        for (uint64_t board_index = 0; board_index < *count; ++board_index) {
+            const auto kind = get(1);
+            const auto height = get(1);
+            if (!kind || !height || all_board_kinds.size() <= *kind || corpus_generator::MaxHeight < *height) {
+                return std::nullopt;
+            }
+
+            CorpusBoard board{static_cast<BoardKind>(*kind), static_cast<uint8_t>(*height), {}};
+            const auto bytes = (board.height + 7) / 8;
+            for (auto &column: board.columns) {
+                const auto value = get(bytes);
+                if (!value) {
+                    return std::nullopt;
+                }
+                column = *value;
+            }
+            boards.push_back(board);
+        }
+        return boards;
+    }
+}
+
+BITRIS_ABI_END
@@ -1,21 +1,43 @@
 #pragma once
 
+#include <array>
 #include <ranges>
+#include <cstdint>
+#include <algorithm>
 #include <iostream>
 #include <experimental/simd>
 
+#include "abi.hpp"
 #include "bits.hpp"
 #include "kicks.hpp"
+#include "lane_shift.hpp"
+#include "templates.hpp"
+
+BITRIS_ABI_BEGIN
 
 namespace stdx = std::experimental;
 
+// 64ビットの値のビットを混ぜて、ハッシュの下位ビットにも上位ビットの影響が出るようにする (MurmurHash3のfmix64)
+[[gnu::always_inline]]
+inline uint64_t mix_hash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccd;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= h >> 33;
+    return h;
+}
+
 template<typename T>
 struct data {
     using type = stdx::simd<T, stdx::simd_abi::fixed_size<10> >;
     using bits_t = bits<T>;
 
+    // stdx::vector_alignedで読み書きするために必要なアラインメント
+    static constexpr size_t alignment = std::max<size_t>(32, stdx::memory_alignment_v<type>);
+
     struct AlignedBoard {
-        alignas(32) std::array<T, 10> columns;
+        alignas(alignment) std::array<T, 10> columns;
     };
 
     [[gnu::always_inline]]
@@ -49,9 +71,10 @@ struct data {
             return calculate_spawn_area(free_space, spawn_cy);
         }
 
-        alignas(32) std::array<T, 10> b{};
+        // spawnの位置が埋まっている場合は、どこにも置けない
+        alignas(alignment) std::array<T, 10> b{};
         b[spawn_cx] = bits_t::one << spawn_cy;
-        return type{b.data(), stdx::vector_aligned};
+        return type{b.data(), stdx::vector_aligned} & free_space;
     }
 
     [[gnu::always_inline]]
@@ -119,6 +142,18 @@ struct data {
         return CeilOpen ? ~(~data >> Down) : data >> Down;
     }
 
+    // seedから、free_spaceの中を下方向にブロックにぶつかるまで塗りつぶす
+    // 1, 2, 4, ...段ずつまとめてずらすため、Steps回で2^Steps - 1段まで落ちる
+    template<size_t Steps = std::bit_width(bits_t::bit_size - 1)>
+    [[gnu::always_inline]]
+    static inline type fill_down(type seed, type free_space) {
+        for (size_t down = 1; down < std::min<size_t>(bits_t::bit_size, 1 << Steps); down <<= 1) {
+            seed |= free_space & (seed >> down);
+            free_space &= free_space >> down;
+        }
+        return seed;
+    }
+
     template<size_t Up>
     [[gnu::always_inline]]
     static inline type shift_up(const type &data) {
@@ -131,7 +166,7 @@ struct data {
         return data << Up;
     }
 
-    template<size_t Right>
+    template<size_t Right, Backend Backend = NativeBackend>
     [[gnu::always_inline]]
     static inline type shift_right(const type &data) {
         if constexpr (Right == 0) {
@@ -140,6 +175,9 @@ struct data {
         if constexpr (10 <= Right) {
             return make_square<0>();
         }
+        if constexpr (lane_shift<T, Backend>::template supports<Right>) {
+            return lane_shift<T, Backend>::template shift_right<Right>(data);
+        }
 
         return type([=](const auto i) {
             if constexpr (constexpr auto index = static_cast<int>(i) - static_cast<int>(Right); index < 0) {
@@ -150,7 +188,7 @@ struct data {
         });
     }
 
-    template<size_t Left>
+    template<size_t Left, Backend Backend = NativeBackend>
     [[gnu::always_inline]]
     static inline type shift_left(const type &data) {
         if constexpr (Left == 0) {
@@ -161,6 +199,10 @@ struct data {
             return make_square<0>();
         }
 
+        if constexpr (lane_shift<T, Backend>::template supports<Left>) {
+            return lane_shift<T, Backend>::template shift_left<Left>(data);
+        }
+
         return type([=](const auto i) {
             if constexpr (constexpr size_t index = i + Left; index >= 10) {
                 return 0;
@@ -211,6 +253,26 @@ struct data {
         return !all_of(left == right);
     }
 
+    // 盤面のハッシュ。列ごとに異なる奇数を掛けて足し合わせ、最後にビットを混ぜる
+    // seedには、形やスポーン位置など、盤面と合わせてキーにする値を渡す
+    static inline uint64_t hash(const std::array<T, 10> &columns, const uint64_t seed) {
+        constexpr std::array<uint64_t, 10> multipliers{
+                0x9e3779b97f4a7c15, 0xbf58476d1ce4e5b9, 0x94d049bb133111eb, 0xd6e8feb86659fd93,
+                0xa0761d6478bd642f, 0xe7037ed1a0b428db, 0x8ebc6af09c88c6e3, 0x589965cc75374cc3,
+                0x1d8e4e27c47d124f, 0xc2b2ae3d27d4eb4f,
+        };
+
+        uint64_t h = seed;
+        static_for<10>([&](const size_t Index) {
+            const auto column = columns[Index];
+            h += static_cast<uint64_t>(column) * multipliers[Index];
+            if constexpr (64 < bits_t::bit_size) {
+                h += static_cast<uint64_t>(column >> 64) * multipliers[9 - Index];
+            }
+        });
+        return mix_hash(h);
+    }
+
     static inline void show(const type &data, const int height = bits_t::bit_size) {
         std::string str;
         for (int y = height - 1; y >= 0; --y) {
@@ -257,3 +319,5 @@ struct data {
         return std::make_optional(board);
     }
 };
+
+BITRIS_ABI_END
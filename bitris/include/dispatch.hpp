@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "search.hpp"
+
+BITRIS_ABI_BEGIN
+
+// 命令セットのレベルごとにビルドした探索カーネルを、実行時にcpuidで選んで呼び出す
+// ヘッダーのsearcherは呼び出し側の-marchでビルドされるのに対し、こちらは1つのバイナリでどのCPUでも速く動く
+// 実体はbitrisライブラリにある (src/dispatch.cpp, src/search_kernels.cpp)
+namespace s {
+    enum class IsaLevel {
+        X86_64_V2 = 2,
+        X86_64_V3 = 3,
+        X86_64_V4 = 4,
+    };
+
+    constexpr std::array<IsaLevel, 3> all_isa_levels{IsaLevel::X86_64_V2, IsaLevel::X86_64_V3, IsaLevel::X86_64_V4};
+
+    const char *isa_level_name(IsaLevel level);
+
+    // このCPUで使えるか
+    bool is_supported(IsaLevel level);
+
+    // 起動時に選んだ、このCPUで使える最も高いレベル
+    IsaLevel selected_isa_level();
+
+    // search_shapeと同じ探索を、起動時に選んだレベルのカーネルで行う
+    // Data は uint8_t, uint16_t, uint32_t, uint64_t のいずれか
+    template<typename Data>
+    std::array<Data, 4 * 10> dispatch_search(const std::array<Data, 10> &board, Shape shape, const Spawn &spawn);
+
+    // レベルを指定して探索する。このCPUで使えないレベルは指定できない
+    template<typename Data>
+    std::array<Data, 4 * 10> dispatch_search(
+            IsaLevel level, const std::array<Data, 10> &board, Shape shape, const Spawn &spawn
+    );
+
+    // 複数の盤面を同じ形で探索する。outはboardsと同じ長さ以上が必要
+    template<typename Data>
+    void dispatch_search_batch(
+            std::span<const std::array<Data, 10> > boards,
+            std::span<const Spawn> spawns,
+            Shape shape,
+            std::span<std::array<Data, 4 * 10> > out
+    );
+}
+
+BITRIS_ABI_END
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <cassert>
+#include <functional>
+
+#include "abi.hpp"
+#include "bits.hpp"
+#include "data.hpp"
+
+BITRIS_ABI_BEGIN
+
+// 盤面の評価に使う特徴量
+struct board_features {
+    // 列ごとの、一番上のブロックの高さ
+    std::array<uint8_t, 10> heights;
+    uint8_t max_height;
+    // 一番深い井戸の列。well_depthが0のときは意味を持たない
+    uint8_t well_column;
+    // 両隣(壁は無限に高いとみなす)の低い方の高さから、列の高さを引いたものの最大値
+    uint8_t well_depth;
+    // 空いていて、上にブロックがあるマスの数
+    uint16_t holes;
+    // 穴より上にあるブロックの数
+    uint16_t covered_cells;
+    // 隣り合う列の高さの差の合計
+    uint16_t bumpiness;
+    // 一番高いブロックより下の行で、横に隣り合うマスの埋まり方が変わる数。左右の壁は埋まっているとみなす
+    uint16_t row_transitions;
+
+    constexpr bool operator==(const board_features &) const = default;
+};
+
+// 列ごとのビット演算をまとめて行い、10列の特徴量を同時に求める
+template<typename Data>
+struct features {
+    using bits_t = bits<Data>;
+    using data_t = data<Data>;
+    using type = typename data_t::type;
+    using AlignedBoard = typename data_t::AlignedBoard;
+
+    [[gnu::always_inline]]
+    static inline board_features extract(const type &board) {
+        // 一番上のブロックより下をすべて1にする
+        const auto below_top = smear_down(board);
+        const auto heights = popcount(below_top);
+
+        const auto holes = ~board & below_top;
+        // 一番下の穴より上をすべて1にしてから、穴の上のブロックを取り出す
+        const auto covered = board & (smear_up(holes) << 1);
+
+        // 最後の列は隣がないため、差を数えない
+        const auto left_heights = data_t::template shift_left<1>(heights);
+        const auto differences = stdx::max(heights, left_heights) - stdx::min(heights, left_heights);
+        const auto bumpiness = stdx::reduce(differences & last_excluded());
+
+        // 左隣と比べる。最初の列の左は壁
+        const auto rows = smear_down(static_cast<Data>(stdx::reduce(board, std::bit_or<>())));
+        const auto left_neighbors = data_t::template shift_right<1>(board) | wall_lane<0>();
+        const auto transitions = (board ^ left_neighbors) & rows;
+        const auto right_wall = static_cast<Data>(~board[9] & rows);
+
+        // 壁は、どの列よりも高いとみなす
+        const auto left_walls = data_t::template shift_right<1>(heights) | wall_lane<0>();
+        const auto right_walls = data_t::template shift_left<1>(heights) | wall_lane<9>();
+        const auto lower_side = stdx::min(left_walls, right_walls);
+        auto wells = data_t::make_zero();
+        where(heights < lower_side, wells) = lower_side - heights;
+        const auto well_depth = stdx::hmax(wells);
+
+        board_features result{};
+        static_for<10>([&](const size_t Index) {
+            result.heights[Index] = static_cast<uint8_t>(heights[Index]);
+        });
+        result.max_height = static_cast<uint8_t>(stdx::hmax(heights));
+        result.well_depth = static_cast<uint8_t>(well_depth);
+        result.well_column = 0 < well_depth ? static_cast<uint8_t>(stdx::find_first_set(wells == well_depth)) : 0;
+        result.holes = static_cast<uint16_t>(stdx::reduce(popcount(holes)));
+        result.covered_cells = static_cast<uint16_t>(stdx::reduce(popcount(covered)));
+        result.bumpiness = static_cast<uint16_t>(bumpiness);
+        result.row_transitions = static_cast<uint16_t>(
+                stdx::reduce(popcount(transitions)) + std::popcount(right_wall)
+        );
+        return result;
+    }
+
+    static inline board_features extract(const AlignedBoard &board) {
+        return extract(data_t::load(board));
+    }
+
+    // outはboardsと同じ長さ以上が必要
+    static inline void extract_batch(const std::span<const AlignedBoard> boards, const std::span<board_features> out) {
+        assert(boards.size() <= out.size());
+        for (size_t index = 0; index < boards.size(); ++index) {
+            out[index] = extract(data_t::load(boards[index]));
+        }
+    }
+
+private:
+    // 列ごとのpopcount。各バイトのビット数を求めてから、掛け算で上位のバイトに集める
+    [[gnu::always_inline]]
+    static inline type popcount(type v) {
+        constexpr Data m1 = bits_t::full / 3;
+        constexpr Data m2 = bits_t::full / 5;
+        constexpr Data m4 = bits_t::full / 17;
+        v = v - ((v >> 1) & m1);
+        v = (v & m2) + ((v >> 2) & m2);
+        v = (v + (v >> 4)) & m4;
+        if constexpr (bits_t::bit_size == 8) {
+            return v;
+        } else {
+            constexpr Data h01 = bits_t::full / 255;
+            return (v * h01) >> (bits_t::bit_size - 8);
+        }
+    }
+
+    template<typename V>
+    [[gnu::always_inline]]
+    static inline V smear_down(V v) {
+        static_for<std::bit_width(bits_t::bit_size - 1)>([&](const size_t Index) {
+            v |= v >> (size_t{1} << Index);
+        });
+        return v;
+    }
+
+    [[gnu::always_inline]]
+    static inline type smear_up(type v) {
+        static_for<std::bit_width(bits_t::bit_size - 1)>([&](const size_t Index) {
+            v |= v << (size_t{1} << Index);
+        });
+        return v;
+    }
+
+    // Index列目だけがすべて1
+    template<size_t Index>
+    [[gnu::always_inline]]
+    static inline type wall_lane() {
+        return type([](const auto i) {
+            return i == Index ? bits_t::full : bits_t::zero;
+        });
+    }
+
+    // 最後の列だけが0
+    [[gnu::always_inline]]
+    static inline type last_excluded() {
+        return type([](const auto i) {
+            return i < 9 ? bits_t::full : bits_t::zero;
+        });
+    }
+};
+
+BITRIS_ABI_END
@@ -1,8 +1,48 @@
 #pragma once
 
+#include "abi.hpp"
 #include "pieces.hpp"
 #include "data.hpp"
 
+BITRIS_ABI_BEGIN
+
+// 複数の形で共通して使う、空白のシフト
+// 横方向のシフトはコストが高いため、まとめて一度だけ計算する
+template<typename Data>
+struct free_space_planes {
+    using data_t = data<Data>;
+    using type = typename data_t::type;
+
+    type block;
+    type d1;
+    type u1;
+    type l1;
+    type r1;
+    type l2;
+    type d1l1;
+    type d1r1;
+    type u1l1;
+    type u1r1;
+
+    [[gnu::always_inline]]
+    static constexpr free_space_planes from(const type &free_space_block) {
+        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
+        const auto u1 = data_t::template shift_up<1>(free_space_block);
+        return {
+                free_space_block,
+                d1,
+                u1,
+                data_t::template shift_left<1>(free_space_block),
+                data_t::template shift_right<1>(free_space_block),
+                data_t::template shift_left<2>(free_space_block),
+                data_t::template shift_left<1>(d1),
+                data_t::template shift_right<1>(d1),
+                data_t::template shift_left<1>(u1),
+                data_t::template shift_right<1>(u1),
+        };
+    }
+};
+
 template<typename, Shape>
 struct free_spaces {
 };
@@ -11,18 +51,23 @@ template<typename Data>
 struct free_spaces<Data, Shape::O> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 1;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
-        return {north(free_space_block)};
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
+        return {north(planes)};
     }
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto d1a = free_space_block & data_t::template shift_down<1, true>(free_space_block);
-        return d1a & data_t::template shift_left<1>(d1a);
+    static constexpr type north(const planes_t &p) {
+        return p.block & p.d1 & p.l1 & p.d1l1;
     }
 };
 
@@ -30,49 +75,43 @@ template<typename Data>
 struct free_spaces<Data, Shape::T> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 4;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
         return {
-                north(free_space_block),
-                east(free_space_block),
-                south(free_space_block),
-                west(free_space_block),
+                north(planes),
+                east(planes),
+                south(planes),
+                west(planes),
         };
     }
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto l1 = data_t::template shift_left<1>(free_space_block);
-        const auto r1 = data_t::template shift_right<1>(free_space_block);
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        return l1 & r1 & d1 & free_space_block;
+    static constexpr type north(const planes_t &p) {
+        return p.l1 & p.r1 & p.d1 & p.block;
     }
 
     [[gnu::always_inline]]
-    static constexpr type east(const type &free_space_block) {
-        const auto l1 = data_t::template shift_left<1>(free_space_block);
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        const auto u1 = data_t::template shift_up<1>(free_space_block);
-        return l1 & d1 & u1 & free_space_block;
+    static constexpr type east(const planes_t &p) {
+        return p.l1 & p.d1 & p.u1 & p.block;
     }
 
     [[gnu::always_inline]]
-    static constexpr type south(const type &free_space_block) {
-        const auto l1 = data_t::template shift_left<1>(free_space_block);
-        const auto r1 = data_t::template shift_right<1>(free_space_block);
-        const auto u1 = data_t::template shift_up<1>(free_space_block);
-        return l1 & r1 & u1 & free_space_block;
+    static constexpr type south(const planes_t &p) {
+        return p.l1 & p.r1 & p.u1 & p.block;
     }
 
     [[gnu::always_inline]]
-    static constexpr type west(const type &free_space_block) {
-        const auto r1 = data_t::template shift_right<1>(free_space_block);
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        const auto u1 = data_t::template shift_up<1>(free_space_block);
-        return r1 & d1 & u1 & free_space_block;
+    static constexpr type west(const planes_t &p) {
+        return p.r1 & p.d1 & p.u1 & p.block;
     }
 };
 
@@ -80,49 +119,43 @@ template<typename Data>
 struct free_spaces<Data, Shape::L> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 4;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
         return {
-                north(free_space_block),
-                east(free_space_block),
-                south(free_space_block),
-                west(free_space_block),
+                north(planes),
+                east(planes),
+                south(planes),
+                west(planes),
         };
     }
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto d1a = free_space_block & data_t::template shift_down<1, true>(free_space_block);
-        const auto d1al1 = data_t::template shift_left<1>(d1a);
-        const auto r1 = data_t::template shift_right<1>(free_space_block);
-        return free_space_block & d1al1 & r1;
+    static constexpr type north(const planes_t &p) {
+        return p.block & p.l1 & p.d1l1 & p.r1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type east(const type &free_space_block) {
-        const auto l1a = free_space_block & data_t::template shift_left<1>(free_space_block);
-        const auto l1au1 = data_t::template shift_up<1>(l1a);
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        return free_space_block & d1 & l1au1;
+    static constexpr type east(const planes_t &p) {
+        return p.block & p.d1 & p.u1 & p.u1l1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type south(const type &free_space_block) {
-        const auto u1a = free_space_block & data_t::template shift_up<1>(free_space_block);
-        const auto u1ar1 = data_t::template shift_right<1>(u1a);
-        const auto l1 = data_t::template shift_left<1>(free_space_block);
-        return free_space_block & u1ar1 & l1;
+    static constexpr type south(const planes_t &p) {
+        return p.block & p.r1 & p.u1r1 & p.l1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type west(const type &free_space_block) {
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        const auto d1r1 = data_t::template shift_right<1>(d1);
-        const auto u1 = data_t::template shift_up<1>(free_space_block);
-        return free_space_block & d1 & u1 & d1r1;
+    static constexpr type west(const planes_t &p) {
+        return p.block & p.d1 & p.u1 & p.d1r1;
     }
 };
 
@@ -130,49 +163,43 @@ template<typename Data>
 struct free_spaces<Data, Shape::J> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 4;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
         return {
-                north(free_space_block),
-                east(free_space_block),
-                south(free_space_block),
-                west(free_space_block),
+                north(planes),
+                east(planes),
+                south(planes),
+                west(planes),
         };
     }
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto d1a = free_space_block & data_t::template shift_down<1, true>(free_space_block);
-        const auto d1ar1 = data_t::template shift_right<1>(d1a);
-        const auto l1 = data_t::template shift_left<1>(free_space_block);
-        return free_space_block & d1ar1 & l1;
+    static constexpr type north(const planes_t &p) {
+        return p.block & p.r1 & p.d1r1 & p.l1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type east(const type &free_space_block) {
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        const auto d1l1 = data_t::template shift_left<1>(d1);
-        const auto u1 = data_t::template shift_up<1>(free_space_block);
-        return free_space_block & d1 & u1 & d1l1;
+    static constexpr type east(const planes_t &p) {
+        return p.block & p.d1 & p.u1 & p.d1l1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type south(const type &free_space_block) {
-        const auto u1a = free_space_block & data_t::template shift_up<1>(free_space_block);
-        const auto u1al1 = data_t::template shift_left<1>(u1a);
-        const auto r1 = data_t::template shift_right<1>(free_space_block);
-        return free_space_block & u1al1 & r1;
+    static constexpr type south(const planes_t &p) {
+        return p.block & p.l1 & p.u1l1 & p.r1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type west(const type &free_space_block) {
-        const auto r1a = free_space_block & data_t::template shift_right<1>(free_space_block);
-        const auto r1au1 = data_t::template shift_up<1>(r1a);
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        return free_space_block & r1au1 & d1;
+    static constexpr type west(const planes_t &p) {
+        return p.block & p.u1 & p.u1r1 & p.d1;
     }
 };
 
@@ -180,12 +207,18 @@ template<typename Data>
 struct free_spaces<Data, Shape::I> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 4;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
-        const auto n = north(free_space_block);
-        const auto w = west(free_space_block);
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
+        const auto n = north(planes);
+        const auto w = west(planes);
         return {
                 n,
                 data_t::template shift_up<1>(w),
@@ -196,14 +229,13 @@ struct free_spaces<Data, Shape::I> {
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto l2a = free_space_block & data_t::template shift_left<2>(free_space_block);
-        return l2a & data_t::template shift_right<1>(l2a);
+    static constexpr type north(const planes_t &p) {
+        return p.block & p.l1 & p.r1 & p.l2;
     }
 
     [[gnu::always_inline]]
-    static constexpr type west(const type &free_space_block) {
-        const auto d2a = free_space_block & data_t::template shift_down<2, true>(free_space_block);
+    static constexpr type west(const planes_t &p) {
+        const auto d2a = p.block & data_t::template shift_down<2, true>(p.block);
         return d2a & data_t::template shift_up<1>(d2a);
     }
 };
@@ -212,12 +244,18 @@ template<typename Data>
 struct free_spaces<Data, Shape::S> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 4;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
-        const auto n = north(free_space_block);
-        const auto e = east(free_space_block);
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
+        const auto n = north(planes);
+        const auto e = east(planes);
         return {
                 n,
                 e,
@@ -228,17 +266,13 @@ struct free_spaces<Data, Shape::S> {
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        const auto d1l1a = free_space_block & data_t::template shift_left<1>(d1);
-        return d1l1a & data_t::template shift_right<1>(d1l1a);
+    static constexpr type north(const planes_t &p) {
+        return p.block & p.d1l1 & p.r1 & p.d1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type east(const type &free_space_block) {
-        const auto d1a = free_space_block & data_t::template shift_down<1, true>(free_space_block);
-        const auto d1al1 = data_t::template shift_left<1>(d1a);
-        return d1a & data_t::template shift_up<1>(d1al1);
+    static constexpr type east(const planes_t &p) {
+        return p.block & p.d1 & p.l1 & p.u1l1;
     }
 };
 
@@ -246,12 +280,18 @@ template<typename Data>
 struct free_spaces<Data, Shape::Z> {
     using data_t = data<Data>;
     using type = typename data_t::type;
+    using planes_t = free_space_planes<Data>;
     static constexpr size_t N = 4;
 
     [[gnu::always_inline]]
     static constexpr std::array<type, N> get(const type &free_space_block) {
-        const auto n = north(free_space_block);
-        const auto e = east(free_space_block);
+        return get(planes_t::from(free_space_block));
+    }
+
+    [[gnu::always_inline]]
+    static constexpr std::array<type, N> get(const planes_t &planes) {
+        const auto n = north(planes);
+        const auto e = east(planes);
         return {
                 n,
                 e,
@@ -262,16 +302,14 @@ struct free_spaces<Data, Shape::Z> {
 
 private:
     [[gnu::always_inline]]
-    static constexpr type north(const type &free_space_block) {
-        const auto d1 = data_t::template shift_down<1, true>(free_space_block);
-        const auto d1lra = free_space_block & data_t::template shift_right<1>(d1);
-        return d1lra & data_t::template shift_left<1>(d1lra);
+    static constexpr type north(const planes_t &p) {
+        return p.block & p.d1r1 & p.l1 & p.d1;
     }
 
     [[gnu::always_inline]]
-    static constexpr type east(const type &free_space_block) {
-        const auto l1 = data_t::template shift_left<1>(free_space_block);
-        const auto l1d1a = free_space_block & data_t::template shift_down<1, true>(l1);
-        return l1d1a & data_t::template shift_up<1>(l1d1a);
+    static constexpr type east(const planes_t &p) {
+        return p.block & p.d1l1 & p.u1 & p.l1;
     }
 };
+
+BITRIS_ABI_END
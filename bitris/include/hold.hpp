@@ -0,0 +1,97 @@
+#pragma once
+
+#include <span>
+#include <optional>
+
+#include "abi.hpp"
+#include "search.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // ホールドを使うかどうか
+    enum class HoldChoice : uint8_t {
+        Current = 0,
+        Hold = 1,
+    };
+
+    // 選択肢ごとの、置く形・置いた後のホールド・置ける位置
+    template<typename Data>
+    struct hold_choice {
+        HoldChoice choice;
+        Shape shape;
+        // 置いた後のホールド
+        std::optional<Shape> next_hold;
+        // ネクストから取り出した数。ホールドが空のときにホールドを使うと1になる
+        size_t consumed_previews;
+        // Oは向きが1つのため、先頭の10列のみを使う
+        std::array<Data, 4 * 10> goals;
+    };
+
+    template<typename Data>
+    struct hold_choices {
+        std::array<hold_choice<Data>, 2> values;
+        size_t size;
+
+        [[nodiscard]] constexpr const hold_choice<Data> *begin() const {
+            return values.data();
+        }
+
+        [[nodiscard]] constexpr const hold_choice<Data> *end() const {
+            return values.data() + size;
+        }
+    };
+
+    // 今の形と、ホールドを使った場合の形(ホールドが空ならネクストの先頭)の置ける位置をまとめて探索する
+    // 盤面の読み込みと空白のシフトは1回だけ行い、2つの形で共有する
+    // ホールドを使っても状態が変わらない場合(ホールドと今の形が同じ)や、使えない場合は、選択肢は1つになる
+    // ホールドが空でネクストの先頭が今の形と同じ場合は、置ける位置は同じでもホールドが変わるため、探索を共有して2つ返す
+    template<typename Data, bool Canonical = false>
+    hold_choices<Data> search_with_hold(
+            const typename data<Data>::AlignedBoard &board,
+            const Shape current,
+            const std::optional<Shape> hold,
+            const std::span<const Shape> previews,
+            const Spawn &spawn
+    ) {
+        using data_t = data<Data>;
+
+        const auto board_t = data_t::load(board);
+        const auto planes = free_space_planes<Data>::from(~board_t);
+
+        const auto search = [&](const Shape shape) {
+            std::array<Data, 4 * 10> result{};
+            dispatch_shape(shape, [&]<Shape Shape>() {
+                using searcher_t = searcher<Data, Shape, Canonical>;
+
+                const auto goals = searcher_t::execute_from_free_spaces(
+                        free_spaces<Data, Shape>::get(planes), spawn.orientation, spawn.cx, spawn.cy
+                );
+                static_for<searcher_t::N>([&](const size_t Index) {
+                    goals[Index].copy_to(&result[Index * 10], stdx::element_aligned);
+                });
+            });
+            return result;
+        };
+
+        hold_choices<Data> choices{};
+        choices.values[0] = {HoldChoice::Current, current, hold, 0, search(current)};
+        choices.size = 1;
+
+        if (hold) {
+            if (*hold != current) {
+                choices.values[1] = {HoldChoice::Hold, *hold, current, 0, search(*hold)};
+                choices.size = 2;
+            }
+        } else if (!previews.empty()) {
+            const auto next = previews.front();
+            const auto goals = next == current ? choices.values[0].goals : search(next);
+            choices.values[1] = {HoldChoice::Hold, next, current, 1, goals};
+            choices.size = 2;
+        }
+
+        return choices;
+    }
+}
+
+BITRIS_ABI_END
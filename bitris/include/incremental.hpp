@@ -0,0 +1,164 @@
+#pragma once
+
+#include "abi.hpp"
+#include "search.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // 親の盤面にブロックを加えた盤面を、親の探索の途中経過を使って探索する
+    // 親で到達できた位置のうち、子でも同じ経路で到達できるものを初期値にして、移動・回転を続ける
+    template<typename Data, Shape Shape, bool Canonical = false, typename Kicks = srs_kicks>
+    struct incremental_searcher {
+        using data_t = data<Data>;
+        using type = typename data_t::type;
+        static constexpr auto N = free_spaces<Data, Shape>::N;
+
+        // 記録する移動・回転の周回数の上限
+        static constexpr size_t MaxRounds = 16;
+
+        // 親の経路を使うのに必要な、親の周回数(開始位置を含む)
+        // 親の探索が短いと、途中から再開しても省ける周回がなく、確認と記録の分だけ遅くなる
+        static constexpr size_t MinParentRounds = 4;
+
+        // 子の盤面の探索に使う、探索の途中経過
+        struct state {
+            type board;
+            Orientation spawn_orientation;
+            uint8_t spawn_cx;
+            uint8_t spawn_cy;
+
+            // rounds[0]は開始位置、rounds[k]はk周目の移動・回転を終えた時点で到達できる位置
+            // rounds[k]の位置には、rounds[k]の中だけを通る経路でrounds[0]から到達できる
+            // また、rounds[k - 1]の位置からの回転先はrounds[k]に含まれる
+            // 記録せずに探索した場合、round_countは0になる
+            std::array<std::array<type, N>, MaxRounds> rounds;
+            size_t round_count;
+        };
+
+        // 探索して、途中経過をoutに書き出す
+        static constexpr std::array<type, N> execute(
+                const type &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy,
+                state &out
+        ) {
+            return searcher_t::dispatch(spawn_orientation, [&]<Orientation Orientation>() {
+                using core = search_core::core_so<Data, Shape, Orientation, Movement::Srs, Kicks>;
+
+                begin(out, board, spawn_orientation, spawn_cx, spawn_cy);
+                const auto all_free_space = free_spaces<Data, Shape>::get(~board);
+                const auto all_reachable = core::spawn(all_free_space, spawn_cx, spawn_cy);
+                record(out, all_reachable);
+
+                return finish<core>(out, all_free_space, all_reachable, {});
+            });
+        }
+
+        // parentの盤面にブロックを加えた盤面を探索して、途中経過をoutに書き出す
+        // 親の経路を使えない場合や、親の探索が短い場合は、記録せずにはじめから探索する
+        // (ブロックが消えている場合、回転のない形、親の開始位置が埋まった場合など)
+        // このとき、outの子はさらにはじめから探索する
+        static constexpr std::array<type, N> execute(const state &parent, const type &board, state &out) {
+            begin(out, board, parent.spawn_orientation, parent.spawn_cx, parent.spawn_cy);
+
+            if (N == 1 || parent.round_count < MinParentRounds ||
+                data_t::is_not_equal_to(parent.board & ~board, 0)) {
+                return searcher_t::execute(board, parent.spawn_orientation, parent.spawn_cx, parent.spawn_cy);
+            }
+
+            return searcher_t::dispatch(parent.spawn_orientation, [&]<Orientation Orientation>() {
+                using core = search_core::core_so<Data, Shape, Orientation, Movement::Srs, Kicks>;
+                constexpr auto spawn_index = static_cast<size_t>(Orientation);
+
+                const auto all_free_space = free_spaces<Data, Shape>::get(~board);
+
+                // 親の経路上の位置が空いたままなら、子でも同じ移動・回転で到達できる
+                // (ブロックを加えても、親で失敗したキックが成功に変わることはない)
+                // roundsは単調に増えるため、空いたままの最後の周回を探す
+                size_t valid = 0;
+                while (valid + 1 < parent.round_count && is_subset(parent.rounds[valid + 1], all_free_space)) {
+                    ++valid;
+                }
+                if (valid == 0) {
+                    return core::template execute_from_free_spaces<Canonical>(
+                            all_free_space, parent.spawn_cx, parent.spawn_cy
+                    );
+                }
+
+                // 親の開始位置に移動だけで届かない場合は、親の経路を使えない
+                const auto spawned = core::spawn(all_free_space, parent.spawn_cx, parent.spawn_cy);
+                auto all_reachable = spawned;
+                all_reachable[spawn_index] = core::move_closure(
+                        all_reachable[spawn_index], all_free_space[spawn_index]
+                );
+                if (!is_subset(parent.rounds[0], all_reachable)) {
+                    return core::template lock<Canonical>(
+                            all_free_space, core::reach_from(all_free_space, all_reachable, {}, [](const auto &) {})
+                    );
+                }
+
+                record(out, spawned);
+                static_for<N>([&](const size_t Index) {
+                    all_reachable[Index] |= parent.rounds[valid][Index];
+                });
+
+                // 1つ前の周回までの位置は、回転先もすでに含まれている
+                return finish<core>(out, all_free_space, all_reachable, parent.rounds[valid - 1]);
+            });
+        }
+
+    private:
+        using searcher_t = searcher<Data, Shape, Canonical, Movement::Srs, Kicks>;
+
+        [[gnu::always_inline]]
+        static constexpr void begin(
+                state &out,
+                const type &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            out.board = board;
+            out.spawn_orientation = spawn_orientation;
+            out.spawn_cx = spawn_cx;
+            out.spawn_cy = spawn_cy;
+            out.round_count = 0;
+        }
+
+        template<typename Core>
+        [[gnu::always_inline]]
+        static constexpr std::array<type, N> finish(
+                state &out,
+                const std::array<type, N> &all_free_space,
+                const std::array<type, N> &all_reachable,
+                const std::array<type, N> &rotated_already
+        ) {
+            const auto reached = Core::reach_from(
+                    all_free_space, all_reachable, rotated_already, [&](const auto &current) {
+                        record(out, current);
+                    }
+            );
+            return Core::template lock<Canonical>(all_free_space, reached);
+        }
+
+        [[gnu::always_inline]]
+        static constexpr void record(state &out, const std::array<type, N> &all_reachable) {
+            if (out.round_count < MaxRounds) {
+                out.rounds[out.round_count++] = all_reachable;
+            }
+        }
+
+        [[gnu::always_inline]]
+        static constexpr bool is_subset(const std::array<type, N> &left, const std::array<type, N> &right) {
+            bool result = true;
+            static_for<N>([&](const size_t Index) {
+                result &= data_t::is_equal_to(left[Index] & ~right[Index], 0);
+            });
+            return result;
+        }
+    };
+}
+
+BITRIS_ABI_END
@@ -2,10 +2,13 @@
 
 #include <cstdint>
 
+#include "abi.hpp"
 #include "pieces.hpp"
 #include "rotate.hpp"
 #include "templates.hpp"
 
+BITRIS_ABI_BEGIN
+
 struct Offset {
     int32_t x, y;
 };
@@ -89,3 +92,61 @@ consteval std::array<Offset, offsets<FromPiece.shape>::N> get_offsets() {
         return Offset{from.x - to.x, from.y - to.y};
     }, from_offsets, to_offsets);
 }
+
+// 180度回転のキック (TETR.IOと同じ順序)
+// 回転前の向きのoffset[0]と回転後の向きのoffset[0]の差を基準とし、そこからずらす
+template<Orientation Orientation>
+consteval std::array<Offset, 6> flip_kicks() {
+    switch (Orientation) {
+        case Orientation::North:
+            return {Offset{0, 0}, {0, 1}, {1, 1}, {-1, 1}, {1, 0}, {-1, 0}};
+        case Orientation::East:
+            return {Offset{0, 0}, {1, 0}, {1, 2}, {1, 1}, {0, 2}, {0, 1}};
+        case Orientation::South:
+            return {Offset{0, 0}, {0, -1}, {-1, -1}, {1, -1}, {-1, 0}, {1, 0}};
+        case Orientation::West:
+            return {Offset{0, 0}, {-1, 0}, {-1, 2}, {-1, 1}, {0, 2}, {0, 1}};
+    }
+    std::unreachable();
+}
+
+// キックテーブル
+// get<FromPiece, Rotation>()で、回転前の位置に足すずらし量を、試す順に返す
+
+// SRS (180度回転なし)
+struct srs_kicks {
+    static constexpr bool has_flip = false;
+
+    template<Piece FromPiece, Rotation Rotation>
+    static consteval auto get() {
+        static_assert(Rotation != Rotation::Flip);
+        return get_offsets<FromPiece, Rotation>();
+    }
+};
+
+// SRSに、TETR.IOと同じ180度回転のキックを加えたもの
+struct srs_flip_kicks {
+    static constexpr bool has_flip = true;
+
+    template<Piece FromPiece, Rotation Rotation>
+    static consteval auto get() {
+        if constexpr (Rotation != Rotation::Flip) {
+            return get_offsets<FromPiece, Rotation>();
+        } else if constexpr (FromPiece.shape == Shape::O) {
+            return get_offsets<FromPiece, Rotation>();
+        } else {
+            constexpr auto from_orientation = FromPiece.orientation;
+            constexpr auto to_orientation = rotate_to(from_orientation, Rotation);
+            constexpr auto from_offset = offsets<FromPiece.shape>::template get<from_orientation>()[0];
+            constexpr auto to_offset = offsets<FromPiece.shape>::template get<to_orientation>()[0];
+
+            auto kicks = flip_kicks<from_orientation>();
+            for (auto &kick: kicks) {
+                kick = Offset{kick.x + from_offset.x - to_offset.x, kick.y + from_offset.y - to_offset.y};
+            }
+            return kicks;
+        }
+    }
+};
+
+BITRIS_ABI_END
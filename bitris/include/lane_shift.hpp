@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstdint>
+#include <experimental/simd>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "abi.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace stdx = std::experimental;
+
+// 列方向(レーン)のずらしに使う命令セット
+enum class Backend {
+    Generic,
+    Avx2,
+    Avx512,
+};
+
+#if defined(__AVX512F__)
+constexpr auto NativeBackend = Backend::Avx512;
+#elif defined(__AVX2__)
+constexpr auto NativeBackend = Backend::Avx2;
+#else
+constexpr auto NativeBackend = Backend::Generic;
+#endif
+
+constexpr const char *backend_name(const Backend backend) {
+    switch (backend) {
+        case Backend::Avx2:
+            return "AVX2";
+        case Backend::Avx512:
+            return "AVX-512";
+        default:
+            return "generic";
+    }
+}
+
+// stdx::simd<T, fixed_size<10>>を、命令セットのベクタに分けたまま、レーンの置換でずらす
+// 10レーンのままでは、生成ラムダが1レーンずつの挿入になる型(u64、AVX2のu32)だけを扱う
+// supports<Amount>がfalseのときは、data<T>の汎用の実装を使う
+template<typename T, Backend Backend>
+struct lane_shift {
+    template<size_t Amount>
+    static constexpr bool supports = false;
+};
+
+// simdの10レーンを揃えた配列に書き出し、命令セットのベクタとして読み書きする
+// simdの内部表現には触れず、公開APIのcopy_to/copy_fromだけを使う(配列を介した読み書きはコンパイラが取り除く)
+template<typename T>
+struct lane_array {
+    using type = stdx::simd<T, stdx::simd_abi::fixed_size<10> >;
+    static constexpr size_t Alignment = 64 < stdx::memory_alignment_v<type> ? stdx::memory_alignment_v<type> : 64;
+
+    alignas(Alignment) T lanes[10];
+
+    lane_array() = default;
+
+    [[gnu::always_inline]]
+    explicit lane_array(const type &data) {
+        data.copy_to(lanes, stdx::vector_aligned);
+    }
+
+    template<typename Vector>
+    [[gnu::always_inline]]
+    [[nodiscard]] inline Vector *at(const size_t index) {
+        return reinterpret_cast<Vector *>(lanes + index);
+    }
+
+    template<typename Vector>
+    [[gnu::always_inline]]
+    [[nodiscard]] inline const Vector *at(const size_t index) const {
+        return reinterpret_cast<const Vector *>(lanes + index);
+    }
+
+    [[gnu::always_inline]]
+    [[nodiscard]] inline type to_simd() const {
+        return type(lanes, stdx::vector_aligned);
+    }
+};
+
+#if defined(__AVX512F__)
+
+// 8レーン + 2レーン
+template<>
+struct lane_shift<uint64_t, Backend::Avx512> {
+    using type = stdx::simd<uint64_t, stdx::simd_abi::fixed_size<10> >;
+
+    // valignqのシフト量は8未満
+    template<size_t Amount>
+    static constexpr bool supports = 0 < Amount && Amount < 8;
+
+    // GCC 12では_mm512_alignr_epi64と_mm512_castsi512_si128が未定義のベクタを介して未初期化の警告を出す
+    // alignrは全レーンのマスクを付けたmaskz版を使い、後ろの2レーンはマスク付きのストアで書き出す
+    template<size_t Right>
+    [[gnu::always_inline]]
+    static inline type shift_right(const type &data) {
+        const lane_array<uint64_t> in{data};
+        const auto low = _mm512_load_si512(in.at<__m512i>(0));
+        const auto high = _mm_load_si128(in.at<__m128i>(8));
+
+        // 後ろの2レーンは、512ビットでずらしてから下位の2レーンを書き出す
+        const auto shifted_high = _mm512_maskz_alignr_epi64(0xff, _mm512_zextsi128_si512(high), low, 8 - Right);
+
+        lane_array<uint64_t> out;
+        _mm512_store_si512(out.at<__m512i>(0), _mm512_maskz_alignr_epi64(0xff, low, _mm512_setzero_si512(), 8 - Right));
+        _mm512_mask_storeu_epi64(out.lanes + 8, 0b11, shifted_high);
+        return out.to_simd();
+    }
+
+    template<size_t Left>
+    [[gnu::always_inline]]
+    static inline type shift_left(const type &data) {
+        const lane_array<uint64_t> in{data};
+        const auto low = _mm512_load_si512(in.at<__m512i>(0));
+        const auto high = _mm_load_si128(in.at<__m128i>(8));
+
+        lane_array<uint64_t> out;
+        _mm512_store_si512(out.at<__m512i>(0), _mm512_maskz_alignr_epi64(0xff, _mm512_zextsi128_si512(high), low, Left));
+        _mm_store_si128(out.at<__m128i>(8), _mm_srli_si128(high, 8 * Left));
+        return out.to_simd();
+    }
+};
+
+#endif
+
+#if defined(__AVX2__) && !defined(__AVX512F__)
+
+// 8レーン + 2レーン
+template<>
+struct lane_shift<uint32_t, Backend::Avx2> {
+    using type = stdx::simd<uint32_t, stdx::simd_abi::fixed_size<10> >;
+
+    // 後ろの2レーンは、palignrで前の128ビットから最大4レーンを持ってくる
+    template<size_t Amount>
+    static constexpr bool supports = 0 < Amount && Amount <= 4;
+
+    // Amountレーンだけ回転させるvpermdのインデックス
+    template<int Amount>
+    [[gnu::always_inline]]
+    static inline __m256i rotation() {
+        return _mm256_setr_epi32(
+                (0 + Amount) & 7, (1 + Amount) & 7, (2 + Amount) & 7, (3 + Amount) & 7,
+                (4 + Amount) & 7, (5 + Amount) & 7, (6 + Amount) & 7, (7 + Amount) & 7
+        );
+    }
+
+    template<size_t Right>
+    [[gnu::always_inline]]
+    static inline type shift_right(const type &data) {
+        const lane_array<uint32_t> in{data};
+        const auto low = _mm256_load_si256(in.at<__m256i>(0));
+        const auto high = _mm_loadl_epi64(in.at<__m128i>(8));
+        const auto rotated = _mm256_permutevar8x32_epi32(low, rotation<-static_cast<int>(Right)>());
+
+        lane_array<uint32_t> out;
+        _mm256_store_si256(out.at<__m256i>(0), _mm256_blend_epi32(rotated, _mm256_setzero_si256(), (1 << Right) - 1));
+        _mm_storel_epi64(out.at<__m128i>(8), _mm_alignr_epi8(high, _mm256_extracti128_si256(low, 1), 16 - 4 * Right));
+        return out.to_simd();
+    }
+
+    template<size_t Left>
+    [[gnu::always_inline]]
+    static inline type shift_left(const type &data) {
+        const lane_array<uint32_t> in{data};
+        const auto low = _mm256_load_si256(in.at<__m256i>(0));
+        const auto high = _mm_loadl_epi64(in.at<__m128i>(8));
+        const auto rotated_low = _mm256_permutevar8x32_epi32(low, rotation<Left>());
+        const auto rotated_high = _mm256_permutevar8x32_epi32(_mm256_zextsi128_si256(high), rotation<Left>());
+
+        lane_array<uint32_t> out;
+        _mm256_store_si256(out.at<__m256i>(0), _mm256_blend_epi32(rotated_low, rotated_high, 0xff & (0xff << (8 - Left))));
+        _mm_storel_epi64(out.at<__m128i>(8), _mm_srli_si128(high, 4 * Left));
+        return out.to_simd();
+    }
+};
+
+// 4レーン + 4レーン + 2レーン
+template<>
+struct lane_shift<uint64_t, Backend::Avx2> {
+    using type = stdx::simd<uint64_t, stdx::simd_abi::fixed_size<10> >;
+
+    // 後ろの2レーンは、palignrで前の128ビットから最大2レーンを持ってくる
+    template<size_t Amount>
+    static constexpr bool supports = 0 < Amount && Amount <= 2;
+
+    // Amountレーンだけ回転させるvpermqの即値
+    template<int Amount>
+    static constexpr int rotation = ((0 + Amount) & 3) | ((1 + Amount) & 3) << 2
+                                    | ((2 + Amount) & 3) << 4 | ((3 + Amount) & 3) << 6;
+
+    // 64ビットのレーンをlanesで選ぶvpblenddの即値
+    static constexpr int blend_mask(const int lanes) {
+        int mask = 0;
+        for (int lane = 0; lane < 4; ++lane) {
+            if (lanes & (1 << lane)) {
+                mask |= 0b11 << (2 * lane);
+            }
+        }
+        return mask;
+    }
+
+    template<size_t Right>
+    [[gnu::always_inline]]
+    static inline type shift_right(const type &data) {
+        const lane_array<uint64_t> in{data};
+        const auto low = _mm256_load_si256(in.at<__m256i>(0));
+        const auto middle = _mm256_load_si256(in.at<__m256i>(4));
+        const auto high = _mm_load_si128(in.at<__m128i>(8));
+        const auto rotated_low = _mm256_permute4x64_epi64(low, rotation<-static_cast<int>(Right)>);
+        const auto rotated_middle = _mm256_permute4x64_epi64(middle, rotation<-static_cast<int>(Right)>);
+        const auto middle1 = _mm256_extracti128_si256(middle, 1);
+        constexpr auto mask = blend_mask((1 << Right) - 1);
+
+        lane_array<uint64_t> out;
+        _mm256_store_si256(out.at<__m256i>(0), _mm256_blend_epi32(rotated_low, _mm256_setzero_si256(), mask));
+        _mm256_store_si256(out.at<__m256i>(4), _mm256_blend_epi32(rotated_middle, rotated_low, mask));
+        if constexpr (Right == 1) {
+            _mm_store_si128(out.at<__m128i>(8), _mm_alignr_epi8(high, middle1, 8));
+        } else {
+            _mm_store_si128(out.at<__m128i>(8), middle1);
+        }
+        return out.to_simd();
+    }
+
+    template<size_t Left>
+    [[gnu::always_inline]]
+    static inline type shift_left(const type &data) {
+        const lane_array<uint64_t> in{data};
+        const auto low = _mm256_load_si256(in.at<__m256i>(0));
+        const auto middle = _mm256_load_si256(in.at<__m256i>(4));
+        const auto high = _mm_load_si128(in.at<__m128i>(8));
+        const auto rotated_low = _mm256_permute4x64_epi64(low, rotation<Left>);
+        const auto rotated_middle = _mm256_permute4x64_epi64(middle, rotation<Left>);
+        const auto rotated_high = _mm256_permute4x64_epi64(_mm256_zextsi128_si256(high), rotation<Left>);
+        constexpr auto mask = blend_mask(0b1111 & (0b1111 << (4 - Left)));
+
+        lane_array<uint64_t> out;
+        _mm256_store_si256(out.at<__m256i>(0), _mm256_blend_epi32(rotated_low, rotated_middle, mask));
+        _mm256_store_si256(out.at<__m256i>(4), _mm256_blend_epi32(rotated_middle, rotated_high, mask));
+        _mm_store_si128(out.at<__m128i>(8), _mm_srli_si128(high, 8 * Left));
+        return out.to_simd();
+    }
+};
+
+#endif
+
+BITRIS_ABI_END
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "cells.hpp"
+#include "data.hpp"
+
+BITRIS_ABI_BEGIN
+
+template<typename Data>
+struct line_clear {
+    using bits_t = bits<Data>;
+    using data_t = data<Data>;
+    using type = typename data_t::type;
+
+    struct result {
+        type board;
+        size_t cleared_lines;
+    };
+
+    // すべての列でブロックが埋まっている行を1とするビット列
+    [[gnu::always_inline]]
+    static inline Data filled_rows(const type &board) {
+        return static_fold_t<10>([&]<size_t Index>(const auto acc) {
+            return static_cast<Data>(acc & board[Index]);
+        }, bits_t::full);
+    }
+
+    // 揃った行を消して、上の行を下に詰める
+    [[gnu::always_inline]]
+    static inline result clear(const type &board) {
+        const auto filled = filled_rows(board);
+        if (filled == 0) {
+            return {board, 0};
+        }
+
+        const auto remaining = static_cast<Data>(~filled);
+        const auto cleared = type([&](const auto i) {
+            return bits_t::extract(board[i], remaining);
+        });
+        return {cleared, static_cast<size_t>(std::popcount(filled))};
+    }
+
+    // 盤面にミノを置く。置く位置が空いていることは呼び出し元で保証する
+    template<Shape Shape>
+    [[gnu::always_inline]]
+    static inline type put(
+            const type &board,
+            const Orientation orientation,
+            const uint8_t x,
+            const uint8_t y
+    ) {
+        constexpr auto all_cells = cells<Shape>::get_all();
+        const auto &piece_cells = all_cells[static_cast<size_t>(orientation)];
+
+        auto placed = board;
+        for (const auto &cell: piece_cells) {
+            const auto cx = static_cast<size_t>(x + cell.x);
+            placed[cx] = static_cast<Data>(placed[cx] | (bits_t::one << (y + cell.y)));
+        }
+        return placed;
+    }
+
+    // ミノを置いてから、揃った行を消す
+    template<Shape Shape>
+    [[gnu::always_inline]]
+    static inline result put_and_clear(
+            const type &board,
+            const Orientation orientation,
+            const uint8_t x,
+            const uint8_t y
+    ) {
+        return clear(put<Shape>(board, orientation, x, y));
+    }
+};
+
+BITRIS_ABI_END
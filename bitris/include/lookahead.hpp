@@ -0,0 +1,289 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <optional>
+#include <algorithm>
+#include <type_traits>
+
+#include "abi.hpp"
+#include "hold.hpp"
+#include "placements.hpp"
+#include "line_clear.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // 読みの最初に置くミノ
+    struct Move {
+        Shape shape;
+        Placement placement;
+        // ホールドを使ったか
+        bool hold;
+
+        constexpr bool operator==(const Move &) const = default;
+    };
+
+    // 評価関数に渡す、読みの末端の盤面
+    template<typename Data>
+    struct Leaf {
+        const typename data<Data>::AlignedBoard &board;
+        std::optional<Shape> hold;
+        // 置いたミノの数
+        size_t depth;
+        // 置き始めてから消した行の数
+        size_t cleared_lines;
+    };
+
+    // ミノの列を先頭から置いていき、max_depth個置いた盤面を評価関数で比べる
+    // 深さごとに、盤面・ホールド・ネクストの位置が同じノードを1つにまとめる
+    // (同じ盤面になるまでに消した行の数は、置いたブロックの数から決まるため、まとめても評価は変わらない)
+    // ノードは深さごとの配列に置き、探索をまたいで使い回す
+    //
+    // Evaluatorは Leaf<Data> を受け取り、大きいほど良い値を返す
+    // 一番上の段を超えるブロックがある置き方は、置けないものとして扱う
+    template<typename Data, typename Evaluator, bool Canonical = true>
+    class lookahead_searcher {
+    public:
+        using AlignedBoard = typename data<Data>::AlignedBoard;
+        using score_t = std::invoke_result_t<const Evaluator &, const Leaf<Data> &>;
+
+        struct result {
+            Move move;
+            score_t score;
+            // 評価した盤面までに置いたミノの数
+            size_t depth;
+        };
+
+        struct stats {
+            // 重複を除いて作ったノードの数
+            size_t nodes;
+            // 同じ深さに同じノードがあったため、捨てたノードの数
+            size_t duplicates;
+            // 評価したノードの数
+            size_t leaves;
+        };
+
+        explicit lookahead_searcher(Evaluator evaluator, const Spawn &spawn = {Orientation::North, 4, 20})
+            : evaluator_(std::move(evaluator)), spawn_(spawn) {
+        }
+
+        // queueの先頭が今のミノで、残りがネクスト
+        // ネクストが足りずにmax_depth個置けない場合は、置けた一番深いところで評価する
+        // 1つも置けない場合はnullopt
+        std::optional<result> search(
+                const AlignedBoard &board,
+                const std::span<const Shape> queue,
+                const std::optional<Shape> hold,
+                const size_t max_depth,
+                const bool use_hold = true
+        ) {
+            assert(queue.size() <= std::numeric_limits<uint8_t>::max());
+
+            stats_ = {};
+            roots_.clear();
+            current_.clear();
+            current_.push_back({board, 0, 0, 0, to_slot(hold)});
+
+            size_t depth = 0;
+            while (depth < max_depth) {
+                next_.clear();
+                reset_slots(current_.size());
+                for (const auto &node: current_) {
+                    expand(node, queue, use_hold, depth == 0);
+                }
+                if (next_.empty()) {
+                    break;
+                }
+                std::swap(current_, next_);
+                ++depth;
+            }
+
+            if (depth == 0) {
+                return std::nullopt;
+            }
+
+            stats_.leaves = current_.size();
+            std::optional<result> best;
+            for (const auto &node: current_) {
+                const auto score = evaluator_(Leaf<Data>{
+                        node.board, from_slot(node.hold), depth, node.cleared_lines,
+                });
+                if (!best || best->score < score) {
+                    best = result{roots_[node.root], score, depth};
+                }
+            }
+            return best;
+        }
+
+        // 最後の探索の統計
+        [[nodiscard]] const stats &last_stats() const {
+            return stats_;
+        }
+
+    private:
+        using data_t = data<Data>;
+        using line_clear_t = line_clear<Data>;
+
+        // ホールドが空であることを表す値
+        static constexpr uint8_t EmptyHold = 0xff;
+
+        struct node {
+            AlignedBoard board;
+            // 最初に置いたミノ。roots_のインデックス
+            uint32_t root;
+            uint16_t cleared_lines;
+            // 次に置くミノのqueueのインデックス
+            uint8_t next;
+            uint8_t hold;
+
+            [[nodiscard]] bool is_same_state(const node &other) const {
+                return board.columns == other.board.columns && next == other.next && hold == other.hold;
+            }
+        };
+
+        Evaluator evaluator_;
+        Spawn spawn_;
+        stats stats_{};
+
+        std::vector<Move> roots_;
+        std::vector<node> current_;
+        std::vector<node> next_;
+
+        // next_のインデックス+1を置くオープンアドレス法のハッシュ表。0は空き
+        std::vector<uint32_t> slots_;
+
+        static uint8_t to_slot(const std::optional<Shape> hold) {
+            return hold ? static_cast<uint8_t>(*hold) : EmptyHold;
+        }
+
+        static std::optional<Shape> from_slot(const uint8_t hold) {
+            return hold == EmptyHold ? std::nullopt : std::optional{static_cast<Shape>(hold)};
+        }
+
+        void expand(const node &parent, const std::span<const Shape> queue, const bool use_hold, const bool is_root) {
+            if (queue.size() <= parent.next) {
+                return;
+            }
+
+            const auto current = queue[parent.next];
+            const auto hold = from_slot(parent.hold);
+
+            hold_choices<Data> choices;
+            if (use_hold) {
+                choices = search_with_hold<Data, Canonical>(
+                        parent.board, current, hold, queue.subspan(parent.next + 1), spawn_
+                );
+            } else {
+                choices.values[0] = {
+                        HoldChoice::Current, current, hold, 0, search_shape<Data, Canonical>(parent.board, current, spawn_),
+                };
+                choices.size = 1;
+            }
+
+            const auto board_t = data_t::load(parent.board);
+            for (const auto &choice: choices) {
+                dispatch_shape(choice.shape, [&]<Shape Shape>() {
+                    using placements_t = placements<Data, Shape>;
+                    constexpr auto N = placements_t::N;
+                    constexpr auto top_offsets = top_cell_offsets<Shape>();
+
+                    std::array<Data, N * 10> goals;
+                    std::copy_n(choice.goals.begin(), N * 10, goals.begin());
+
+                    // Canonicalの場合、goalsは既にまとめてある
+                    const auto list = placements_t::template extract<false>(goals);
+                    for (const auto &placement: list) {
+                        const auto orientation_index = N == 1 ? 0 : static_cast<size_t>(placement.orientation);
+                        if (static_cast<int>(bits<Data>::bit_size) <= placement.y + top_offsets[orientation_index]) {
+                            continue;
+                        }
+
+                        const auto [placed, cleared_lines] = line_clear_t::template put_and_clear<Shape>(
+                                board_t, placement.orientation, placement.x, placement.y
+                        );
+
+                        node child{
+                                {},
+                                is_root ? static_cast<uint32_t>(roots_.size()) : parent.root,
+                                static_cast<uint16_t>(parent.cleared_lines + cleared_lines),
+                                static_cast<uint8_t>(parent.next + 1 + choice.consumed_previews),
+                                to_slot(choice.next_hold),
+                        };
+                        placed.copy_to(child.board.columns.data(), stdx::vector_aligned);
+
+                        if (insert(child) && is_root) {
+                            roots_.push_back({Shape, placement, choice.choice == HoldChoice::Hold});
+                        }
+                    }
+                });
+            }
+        }
+
+        // 向きごとの、回転の中心から一番上のブロックまでの高さ
+        template<Shape Shape>
+        static constexpr std::array<int, 4> top_cell_offsets() {
+            constexpr auto all_cells = cells<Shape>::get_all();
+            std::array<int, 4> offsets{};
+            for (size_t index = 0; index < all_cells.size(); ++index) {
+                for (const auto &cell: all_cells[index]) {
+                    offsets[index] = std::max(offsets[index], cell.y);
+                }
+            }
+            return offsets;
+        }
+
+        // 子の数は分からないため、親の数から見積もった大きさで始め、埋まってきたら広げる
+        void reset_slots(const size_t parents) {
+            const auto size = std::bit_ceil(std::max<size_t>(parents * 64, 1024));
+            if (slots_.size() < size) {
+                slots_.resize(size);
+            }
+            std::fill(slots_.begin(), slots_.end(), 0);
+        }
+
+        // 同じノードがなければnext_に加えてtrueを返す
+        bool insert(const node &child) {
+            if (slots_.size() < (next_.size() + 1) * 2) {
+                grow();
+            }
+
+            const auto mask = slots_.size() - 1;
+            for (auto index = hash(child) & mask;; index = (index + 1) & mask) {
+                const auto slot = slots_[index];
+                if (slot == 0) {
+                    next_.push_back(child);
+                    slots_[index] = static_cast<uint32_t>(next_.size());
+                    ++stats_.nodes;
+                    return true;
+                }
+                if (next_[slot - 1].is_same_state(child)) {
+                    ++stats_.duplicates;
+                    return false;
+                }
+            }
+        }
+
+        void grow() {
+            slots_.assign(slots_.size() * 2, 0);
+            const auto mask = slots_.size() - 1;
+            for (size_t position = 0; position < next_.size(); ++position) {
+                auto index = hash(next_[position]) & mask;
+                while (slots_[index] != 0) {
+                    index = (index + 1) & mask;
+                }
+                slots_[index] = static_cast<uint32_t>(position + 1);
+            }
+        }
+
+        static size_t hash(const node &node) {
+            const uint64_t seed = static_cast<uint64_t>(node.next) << 8 | node.hold;
+            return static_cast<size_t>(data<Data>::hash(node.board.columns, seed));
+        }
+    };
+}
+
+BITRIS_ABI_END
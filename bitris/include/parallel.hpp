@@ -0,0 +1,200 @@
+#pragma once
+
+#include <span>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cassert>
+
+#include "abi.hpp"
+#include "search.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    template<typename Data>
+    struct Job {
+        typename data<Data>::AlignedBoard board;
+        Shape shape;
+        Spawn spawn;
+    };
+
+    // ジョブを複数のスレッドで探索する
+    // 各スレッドは連続したジョブの範囲を持ち、自分の範囲がなくなったら他のスレッドの範囲の後ろ半分を奪う
+    // 結果はジョブと同じ順にoutへ書き出す。Oは向きが1つのため、先頭の10列のみを使う
+    template<typename Data, bool Canonical = false>
+    class parallel_searcher {
+    public:
+        using result_t = std::array<Data, 4 * 10>;
+
+        // スレッド間で共有する変数は、別々のキャッシュラインに置く
+        static constexpr size_t CacheLineSize = 64;
+
+        // 一度に取り出すジョブの数
+        static constexpr uint32_t ChunkSize = 4;
+
+        // thread_countは呼び出し元のスレッドを含む
+        explicit parallel_searcher(const size_t thread_count = std::thread::hardware_concurrency())
+            : workers_(std::max<size_t>(1, thread_count)) {
+            threads_.reserve(workers_.size() - 1);
+            for (size_t index = 1; index < workers_.size(); ++index) {
+                threads_.emplace_back([this, index] { run(index); });
+            }
+        }
+
+        parallel_searcher(const parallel_searcher &) = delete;
+
+        parallel_searcher &operator=(const parallel_searcher &) = delete;
+
+        ~parallel_searcher() {
+            stopped_.store(true, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            generation_.notify_all();
+            for (auto &thread: threads_) {
+                thread.join();
+            }
+        }
+
+        [[nodiscard]] size_t thread_count() const {
+            return workers_.size();
+        }
+
+        // outはjobsと同じ長さ以上が必要
+        void search(const std::span<const Job<Data> > jobs, const std::span<result_t> out) {
+            assert(jobs.size() <= out.size());
+            assert(jobs.size() <= std::numeric_limits<uint32_t>::max());
+
+            jobs_ = jobs;
+            out_ = out;
+            remaining_.store(jobs.size(), std::memory_order_relaxed);
+
+            // はじめは均等に分ける
+            const auto size = static_cast<uint32_t>(jobs.size());
+            const auto count = static_cast<uint32_t>(workers_.size());
+            for (uint32_t index = 0; index < count; ++index) {
+                const auto begin = static_cast<uint32_t>(static_cast<uint64_t>(size) * index / count);
+                const auto end = static_cast<uint32_t>(static_cast<uint64_t>(size) * (index + 1) / count);
+                workers_[index].range.store(pack(begin, end), std::memory_order_relaxed);
+            }
+
+            active_.store(threads_.size(), std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            generation_.notify_all();
+
+            work(0);
+
+            // 他のスレッドがジョブと範囲に触れなくなるまで待つ
+            for (auto active = active_.load(std::memory_order_acquire); active != 0;
+                 active = active_.load(std::memory_order_acquire)) {
+                active_.wait(active, std::memory_order_acquire);
+            }
+        }
+
+        // 1つのジョブを探索する
+        static constexpr result_t search_one(const Job<Data> &job) {
+            return search_shape<Data, Canonical>(job.board, job.shape, job.spawn);
+        }
+
+    private:
+        // [begin, end)を1つの値にまとめ、CASで奪い合えるようにする
+        struct alignas(CacheLineSize) worker {
+            std::atomic<uint64_t> range{0};
+        };
+
+        std::vector<worker> workers_;
+        std::vector<std::thread> threads_;
+
+        alignas(CacheLineSize) std::atomic<uint64_t> generation_{0};
+        alignas(CacheLineSize) std::atomic<size_t> remaining_{0};
+        alignas(CacheLineSize) std::atomic<size_t> active_{0};
+        std::atomic<bool> stopped_{false};
+
+        std::span<const Job<Data> > jobs_;
+        std::span<result_t> out_;
+
+        static constexpr uint64_t pack(const uint32_t begin, const uint32_t end) {
+            return static_cast<uint64_t>(end) << 32 | begin;
+        }
+
+        static constexpr uint32_t begin_of(const uint64_t range) {
+            return static_cast<uint32_t>(range);
+        }
+
+        static constexpr uint32_t end_of(const uint64_t range) {
+            return static_cast<uint32_t>(range >> 32);
+        }
+
+        void run(const size_t index) {
+            uint64_t generation = 0;
+            while (true) {
+                generation_.wait(generation, std::memory_order_acquire);
+                generation = generation_.load(std::memory_order_acquire);
+                if (stopped_.load(std::memory_order_relaxed)) {
+                    return;
+                }
+
+                work(index);
+
+                if (active_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    active_.notify_all();
+                }
+            }
+        }
+
+        void work(const size_t index) {
+            auto &own = workers_[index].range;
+            while (0 < remaining_.load(std::memory_order_acquire)) {
+                if (const auto taken = take(own); begin_of(taken) < end_of(taken)) {
+                    for (auto job = begin_of(taken); job < end_of(taken); ++job) {
+                        out_[job] = search_one(jobs_[job]);
+                    }
+                    remaining_.fetch_sub(end_of(taken) - begin_of(taken), std::memory_order_acq_rel);
+                    continue;
+                }
+
+                if (!steal(index)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // 自分の範囲の先頭からChunkSize個を取り出す
+        static uint64_t take(std::atomic<uint64_t> &own) {
+            auto range = own.load(std::memory_order_acquire);
+            while (true) {
+                const auto begin = begin_of(range);
+                const auto end = end_of(range);
+                if (end <= begin) {
+                    return pack(0, 0);
+                }
+
+                const auto next = std::min(end, begin + ChunkSize);
+                if (own.compare_exchange_weak(range, pack(next, end), std::memory_order_acq_rel)) {
+                    return pack(begin, next);
+                }
+            }
+        }
+
+        // 他のスレッドの範囲の後ろ半分を自分の範囲にする
+        // 自分の範囲は空なので、他のスレッドから奪われることはない
+        bool steal(const size_t index) {
+            const auto count = workers_.size();
+            for (size_t offset = 1; offset < count; ++offset) {
+                auto &victim = workers_[(index + offset) % count].range;
+                auto range = victim.load(std::memory_order_acquire);
+                while (begin_of(range) < end_of(range)) {
+                    const auto begin = begin_of(range);
+                    const auto end = end_of(range);
+                    const auto mid = end - (end - begin + 1) / 2;
+                    if (victim.compare_exchange_weak(range, pack(begin, mid), std::memory_order_acq_rel)) {
+                        workers_[index].range.store(pack(mid, end), std::memory_order_release);
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+    };
+}
+
+BITRIS_ABI_END
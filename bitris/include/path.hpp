@@ -0,0 +1,250 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <cassert>
+#include <algorithm>
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "rotate.hpp"
+#include "kicks.hpp"
+#include "data.hpp"
+#include "free_spaces.hpp"
+#include "placements.hpp"
+#include "search_core.hpp"
+
+BITRIS_ABI_BEGIN
+
+enum class Input {
+    Left = 0,
+    Right = 1,
+    SoftDrop = 2,
+    Cw = 3,
+    Ccw = 4,
+    Flip = 5,
+};
+
+// 操作の手順を復元するための探索
+// searcherとは別に、1操作ごとに到達した位置を世代として記録しながら幅優先で探索する
+template<typename Data, Shape Shape, typename Kicks = srs_kicks>
+struct path_finder {
+    using bits_t = bits<Data>;
+    using data_t = data<Data>;
+    using type = typename data_t::type;
+    static constexpr auto N = free_spaces<Data, Shape>::N;
+
+    struct layers {
+        std::array<type, N> all_free_space;
+        // layers[g]は、g回の操作で初めて到達する位置
+        std::vector<std::array<type, N> > generations;
+        Orientation spawn_orientation;
+        uint8_t spawn_cx;
+        uint8_t spawn_cy;
+    };
+
+    static layers execute(
+            const type &board,
+            const Orientation spawn_orientation,
+            const uint8_t spawn_cx,
+            const uint8_t spawn_cy
+    ) {
+        const auto all_free_space = free_spaces<Data, Shape>::get(~board);
+        const auto spawn_index = N == 1 ? 0 : static_cast<size_t>(spawn_orientation);
+
+        // spawnが盤面の上にある場合は、searcherと同じくspawnできる範囲をまとめて始点とする
+        auto frontier = std::array<type, N>{};
+        if (spawn_cy < bits_t::bit_size) {
+            frontier[spawn_index][spawn_cx] = static_cast<Data>(bits_t::one << spawn_cy);
+            frontier[spawn_index] &= all_free_space[spawn_index];
+        } else {
+            frontier[spawn_index] = data_t::make_spawn(all_free_space[spawn_index], spawn_cx, spawn_cy);
+        }
+
+        layers result{all_free_space, {}, spawn_orientation, spawn_cx, spawn_cy};
+        auto visited = frontier;
+
+        while (true) {
+            bool any = false;
+            static_for<N>([&](const size_t Index) {
+                any |= data_t::is_not_equal_to(frontier[Index], 0);
+            });
+            if (!any) {
+                break;
+            }
+            result.generations.push_back(frontier);
+
+            auto next = std::array<type, N>{};
+            static_for<N>([&](const size_t Index) {
+                const auto &f = frontier[Index];
+                next[Index] = data_t::template shift_left<1>(f) | data_t::template shift_right<1>(f) |
+                              data_t::template shift_down<1>(f);
+            });
+
+            if constexpr (N == 4) {
+                static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                        [&]<Orientation From>() {
+                            constexpr auto from_index = static_cast<size_t>(From);
+                            const auto src = frontier[from_index] & rotatable_mask();
+                            static_for_t<rotations()>([&]<Rotation R>() {
+                                constexpr auto to_index = static_cast<size_t>(rotate_to(From, R));
+                                next[to_index] |= search_core::core_sor<Data, Shape, From, R, Kicks>::rotate(
+                                        src, all_free_space[to_index]
+                                );
+                            });
+                        });
+            }
+
+            static_for<N>([&](const size_t Index) {
+                next[Index] = next[Index] & all_free_space[Index] & ~visited[Index];
+                visited[Index] |= next[Index];
+            });
+            frontier = next;
+        }
+
+        return result;
+    }
+
+    // goalまでの最短の操作を復元する。到達できない場合はnullopt
+    // goalはcanonicalにまとめる前の向きで指定する
+    static std::optional<std::vector<Input> > reconstruct(const layers &layers, const Placement &goal) {
+        auto current = goal;
+        if (N == 1 && current.orientation != Orientation::North) {
+            return std::nullopt;
+        }
+
+        size_t generation = 0;
+        while (generation < layers.generations.size() && !contains(layers.generations[generation], current)) {
+            ++generation;
+        }
+        if (generation == layers.generations.size()) {
+            return std::nullopt;
+        }
+
+        std::vector<Input> inputs;
+        for (; 0 < generation; --generation) {
+            const auto &prev = layers.generations[generation - 1];
+            const auto found = find_prev(layers.all_free_space, prev, current);
+            assert(found.has_value());
+            inputs.push_back(found->first);
+            current = found->second;
+        }
+
+        // 始点がspawn位置でない場合は、spawnできる範囲を横移動してから落下する
+        const auto spawn_y = static_cast<int>(layers.spawn_cy);
+        for (int y = current.y; y < spawn_y; ++y) {
+            inputs.push_back(Input::SoftDrop);
+        }
+        for (auto x = static_cast<int>(current.x); x < layers.spawn_cx; ++x) {
+            inputs.push_back(Input::Left);
+        }
+        for (auto x = static_cast<int>(current.x); layers.spawn_cx < x; --x) {
+            inputs.push_back(Input::Right);
+        }
+
+        std::ranges::reverse(inputs);
+        return inputs;
+    }
+
+private:
+    static consteval auto rotations() {
+        if constexpr (Kicks::has_flip) {
+            return std::array{Rotation::Cw, Rotation::Ccw, Rotation::Flip};
+        } else {
+            return std::array{Rotation::Cw, Rotation::Ccw};
+        }
+    }
+
+    static constexpr Input to_input(const Rotation rotation) {
+        switch (rotation) {
+            case Rotation::Cw:
+                return Input::Cw;
+            case Rotation::Ccw:
+                return Input::Ccw;
+            case Rotation::Flip:
+                return Input::Flip;
+        }
+        std::unreachable();
+    }
+
+    [[gnu::always_inline]]
+    static inline type rotatable_mask() {
+        return data_t::template make_square<(bits_t::full >> 2)>();
+    }
+
+    static bool contains(const std::array<type, N> &planes, const Placement &placement) {
+        return contains(planes, static_cast<size_t>(placement.orientation), placement.x, placement.y);
+    }
+
+    static bool contains(const std::array<type, N> &planes, const size_t index, const int x, const int y) {
+        if (x < 0 || 10 <= x || y < 0 || static_cast<int>(bits_t::bit_size) <= y) {
+            return false;
+        }
+        return planes[index][x] & (bits_t::one << y);
+    }
+
+    // prevの位置から1操作でcurrentに到達できる操作と、そのときの位置を探す
+    static std::optional<std::pair<Input, Placement> > find_prev(
+            const std::array<type, N> &all_free_space,
+            const std::array<type, N> &prev,
+            const Placement &current
+    ) {
+        const auto index = static_cast<size_t>(current.orientation);
+        const int x = current.x;
+        const int y = current.y;
+
+        const auto make = [&](const Input input, const Orientation orientation, const int px, const int py) {
+            return std::make_optional(std::make_pair(
+                    input, Placement{orientation, static_cast<uint8_t>(px), static_cast<uint8_t>(py)}
+            ));
+        };
+
+        if (contains(prev, index, x + 1, y)) {
+            return make(Input::Left, current.orientation, x + 1, y);
+        }
+        if (contains(prev, index, x - 1, y)) {
+            return make(Input::Right, current.orientation, x - 1, y);
+        }
+        if (contains(prev, index, x, y + 1)) {
+            return make(Input::SoftDrop, current.orientation, x, y + 1);
+        }
+
+        std::optional<std::pair<Input, Placement> > found = std::nullopt;
+        if constexpr (N == 4) {
+            static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                    [&]<Orientation From>() {
+                        static_for_t<rotations()>([&]<Rotation R>() {
+                            if (found || rotate_to(From, R) != current.orientation) {
+                                return;
+                            }
+
+                            constexpr auto offsets = Kicks::template get<{Shape, From}, R>();
+                            constexpr auto from_index = static_cast<size_t>(From);
+                            for (size_t k = 0; k < offsets.size(); ++k) {
+                                const auto sx = x - offsets[k].x;
+                                const auto sy = y - offsets[k].y;
+                                if (!contains(prev, from_index, sx, sy) || static_cast<int>(bits_t::bit_size) - 2 <= sy) {
+                                    continue;
+                                }
+
+                                // 先に試されるキックがすべて失敗している
+                                bool is_first_kick = true;
+                                for (size_t j = 0; j < k; ++j) {
+                                    if (contains(all_free_space, index, sx + offsets[j].x, sy + offsets[j].y)) {
+                                        is_first_kick = false;
+                                        break;
+                                    }
+                                }
+                                if (is_first_kick) {
+                                    found = make(to_input(R), From, sx, sy);
+                                    return;
+                                }
+                            }
+                        });
+                    });
+        }
+        return found;
+    }
+};
+
+BITRIS_ABI_END
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <optional>
+#include <algorithm>
+
+#include "abi.hpp"
+#include "hold.hpp"
+#include "lookahead.hpp"
+#include "placements.hpp"
+#include "line_clear.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // 下からheight段を、ミノを置いてすべて消す置き方を探す
+    // 盤面はdata<uint8_t>で持ち、heightは6段まで
+    //
+    // 各ノードでは、今のミノとホールドを使った場合の置き方をsearch_with_holdでまとめて求め、深さ優先でたどる
+    // 解がないと分かった盤面は、置いたミノの数ごとのハッシュ集合に覚えておき、同じ状態になったら打ち切る
+    // 最初の置き方ごとに、複数のスレッドで分けて探す
+    class perfect_clear_finder {
+    public:
+        using Data = uint8_t;
+        using AlignedBoard = data<Data>::AlignedBoard;
+        using solution = std::vector<Move>;
+
+        static constexpr size_t MaxHeight = 6;
+
+        // thread_countは呼び出し元のスレッドを含む
+        explicit perfect_clear_finder(
+                const size_t thread_count = std::thread::hardware_concurrency(),
+                const Spawn &spawn = {Orientation::North, 4, 20}
+        ) : thread_count_(std::max<size_t>(1, thread_count)), spawn_(spawn) {
+        }
+
+        [[nodiscard]] size_t thread_count() const {
+            return thread_count_;
+        }
+
+        // 解があるか
+        bool exists(
+                const AlignedBoard &board,
+                const std::span<const Shape> queue,
+                const std::optional<Shape> hold,
+                const size_t height
+        ) const {
+            return !run(board, queue, hold, height, false).empty();
+        }
+
+        // すべての解。最初の置き方の順に並ぶ
+        std::vector<solution> find_all(
+                const AlignedBoard &board,
+                const std::span<const Shape> queue,
+                const std::optional<Shape> hold,
+                const size_t height
+        ) const {
+            return run(board, queue, hold, height, true);
+        }
+
+    private:
+        using data_t = data<Data>;
+        using type = data_t::type;
+        using line_clear_t = line_clear<Data>;
+
+        // ホールドが空であることを表す値
+        static constexpr uint8_t EmptyHold = 7;
+
+        struct state {
+            AlignedBoard board;
+            // 今の天井。揃った行を消すと下がる
+            uint8_t height;
+            // 次に置くミノのqueueのインデックス
+            uint8_t next;
+            uint8_t hold;
+            // 置いたミノの数
+            uint8_t placed;
+        };
+
+        struct root {
+            Move move;
+            state child;
+        };
+
+        // 0を空きとする、64ビットのキーのオープンアドレス法のハッシュ集合
+        class compact_set {
+        public:
+            [[nodiscard]] bool contains(const uint64_t key) const {
+                if (keys_.empty()) {
+                    return false;
+                }
+                const auto mask = keys_.size() - 1;
+                for (auto index = static_cast<size_t>(mix_hash(key)) & mask;; index = (index + 1) & mask) {
+                    if (keys_[index] == key) {
+                        return true;
+                    }
+                    if (keys_[index] == 0) {
+                        return false;
+                    }
+                }
+            }
+
+            void insert(const uint64_t key) {
+                if (keys_.size() < (size_ + 1) * 2) {
+                    grow();
+                }
+                const auto mask = keys_.size() - 1;
+                for (auto index = static_cast<size_t>(mix_hash(key)) & mask;; index = (index + 1) & mask) {
+                    if (keys_[index] == key) {
+                        return;
+                    }
+                    if (keys_[index] == 0) {
+                        keys_[index] = key;
+                        ++size_;
+                        return;
+                    }
+                }
+            }
+
+        private:
+            std::vector<uint64_t> keys_;
+            size_t size_ = 0;
+
+            void grow() {
+                const auto old = std::move(keys_);
+                keys_.assign(std::max<size_t>(old.size() * 2, 1024), 0);
+                size_ = 0;
+                for (const auto key: old) {
+                    if (key != 0) {
+                        insert(key);
+                    }
+                }
+            }
+        };
+
+        // スレッドごとの作業領域
+        struct worker {
+            const perfect_clear_finder &finder;
+            std::span<const Shape> queue;
+            bool find_all;
+            const std::atomic<bool> &stopped;
+
+            // 置いたミノの数ごとの、解がない状態
+            std::vector<compact_set> failed;
+            std::vector<Move> moves;
+            std::vector<solution> solutions;
+
+            // 解が見つかったらtrue
+            bool dfs(const state &current) {
+                if (current.height == 0) {
+                    solutions.push_back(moves);
+                    return true;
+                }
+                if (stopped.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+
+                const auto key = make_key(current);
+                if (failed[current.placed].contains(key)) {
+                    return false;
+                }
+
+                bool found = false;
+                finder.for_each_child(current, queue, [&](const Move &move, const state &child) {
+                    moves.push_back(move);
+                    found |= dfs(child);
+                    moves.pop_back();
+                    // 解があるかだけ調べる場合は、1つ見つかれば終える
+                    return !found || find_all;
+                });
+
+                if (!found) {
+                    failed[current.placed].insert(key);
+                }
+                return found;
+            }
+        };
+
+        size_t thread_count_;
+        Spawn spawn_;
+
+        std::vector<solution> run(
+                const AlignedBoard &board,
+                const std::span<const Shape> queue,
+                const std::optional<Shape> hold,
+                const size_t height,
+                const bool find_all
+        ) const {
+            assert(0 < height && height <= MaxHeight);
+            assert(queue.size() <= std::numeric_limits<uint8_t>::max());
+
+            // 天井より上にブロックがあると、消しきれない
+            const auto ceiling_mask = static_cast<Data>((1u << height) - 1);
+            size_t blocks = 0;
+            for (const auto column: board.columns) {
+                if (column & ~ceiling_mask) {
+                    return {};
+                }
+                blocks += std::popcount(column);
+            }
+
+            // 置くミノの数が決まる。ミノはqueueから1つずつ置くため、queueより多くは置けない
+            const auto empty_cells = 10 * height - blocks;
+            if (empty_cells % 4 != 0 || queue.size() < empty_cells / 4) {
+                return {};
+            }
+
+            const auto max_pieces = empty_cells / 4;
+            if (max_pieces == 0) {
+                return {solution{}};
+            }
+
+            const state start{
+                    board,
+                    static_cast<uint8_t>(height),
+                    0,
+                    hold ? static_cast<uint8_t>(*hold) : EmptyHold,
+                    0,
+            };
+
+            // 最初の置き方を、スレッドに分ける
+            std::vector<root> roots;
+            for_each_child(start, queue, [&](const Move &move, const state &child) {
+                roots.push_back({move, child});
+                return true;
+            });
+
+            std::vector<std::vector<solution> > results(roots.size());
+            std::atomic<size_t> next_root{0};
+            std::atomic<bool> stopped{false};
+
+            const auto work = [&]() {
+                worker w{*this, queue, find_all, stopped, std::vector<compact_set>(max_pieces + 1), {}, {}};
+                while (true) {
+                    const auto index = next_root.fetch_add(1, std::memory_order_relaxed);
+                    if (roots.size() <= index || stopped.load(std::memory_order_relaxed)) {
+                        break;
+                    }
+
+                    w.moves.assign(1, roots[index].move);
+                    w.solutions.clear();
+                    if (w.dfs(roots[index].child) && !find_all) {
+                        stopped.store(true, std::memory_order_relaxed);
+                    }
+                    results[index] = std::move(w.solutions);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            const auto count = std::min(thread_count_, roots.size());
+            for (size_t index = 1; index < count; ++index) {
+                threads.emplace_back(work);
+            }
+            work();
+            for (auto &thread: threads) {
+                thread.join();
+            }
+
+            std::vector<solution> solutions;
+            for (auto &result: results) {
+                for (auto &found: result) {
+                    solutions.push_back(std::move(found));
+                    if (!find_all) {
+                        return solutions;
+                    }
+                }
+            }
+            return solutions;
+        }
+
+        // 空いているマスを縦横につながった領域に分けたとき、すべての領域の大きさが4の倍数か
+        // 領域は、1つのマスから縦横に広げる操作を変わらなくなるまで繰り返して求める
+        static bool is_divisible_into_pieces(const type &board, const uint8_t height) {
+            auto remaining = ~board & data_t::make_square(static_cast<Data>((1u << height) - 1));
+            while (!data_t::is_equal_to(remaining, Data{0})) {
+                // 一番左の列の、一番下の空いているマスから広げる
+                type region = data_t::make_zero();
+                for (size_t x = 0; x < 10; ++x) {
+                    if (const Data column = remaining[x]) {
+                        region[x] = static_cast<Data>(column & -column);
+                        break;
+                    }
+                }
+
+                while (true) {
+                    const auto expanded = (region
+                                           | data_t::shift_up<1>(region) | data_t::shift_down<1>(region)
+                                           | data_t::shift_right<1>(region) | data_t::shift_left<1>(region))
+                                          & remaining;
+                    if (data_t::is_equal_to(expanded, region)) {
+                        break;
+                    }
+                    region = expanded;
+                }
+
+                size_t cells = 0;
+                for (size_t x = 0; x < 10; ++x) {
+                    cells += std::popcount(static_cast<Data>(region[x]));
+                }
+                if (cells % 4 != 0) {
+                    return false;
+                }
+                remaining &= ~region;
+            }
+            return true;
+        }
+
+        // 各列の下から6段とホールドを、64ビットにまとめる。0にならないよう、4ビット目を立てる
+        static uint64_t make_key(const state &current) {
+            uint64_t key = 0b1000 | current.hold;
+            for (size_t x = 0; x < 10; ++x) {
+                key |= static_cast<uint64_t>(current.board.columns[x]) << (4 + 6 * x);
+            }
+            return key;
+        }
+
+        // 天井を超えずに置ける置き方と、置いた後の状態でfを呼ぶ。fがfalseを返したら終える
+        template<typename F>
+        void for_each_child(const state &current, const std::span<const Shape> queue, F &&f) const {
+            if (queue.size() <= current.next) {
+                return;
+            }
+
+            const auto board_t = data_t::load(current.board);
+            if (!is_divisible_into_pieces(board_t, current.height)) {
+                return;
+            }
+
+            const auto hold = current.hold == EmptyHold
+                              ? std::nullopt
+                              : std::optional{static_cast<Shape>(current.hold)};
+            const auto choices = search_with_hold<Data, true>(
+                    current.board, queue[current.next], hold, queue.subspan(current.next + 1), spawn_
+            );
+
+            for (const auto &choice: choices) {
+                const auto proceed = dispatch_shape(choice.shape, [&]<Shape Shape>() {
+                    using placements_t = placements<Data, Shape>;
+                    constexpr auto N = placements_t::N;
+                    constexpr auto all_cells = cells<Shape>::get_all();
+
+                    std::array<Data, N * 10> goals;
+                    std::copy_n(choice.goals.begin(), N * 10, goals.begin());
+
+                    // goalsは同じブロックを占める向きをまとめてある
+                    for (const auto &placement: placements_t::template extract<false>(goals)) {
+                        const auto &piece_cells = all_cells[N == 1 ? 0 : static_cast<size_t>(placement.orientation)];
+                        const auto top = std::ranges::max(piece_cells, {}, &Offset::y).y;
+                        if (current.height <= placement.y + top) {
+                            continue;
+                        }
+
+                        const auto [placed, cleared_lines] = line_clear_t::template put_and_clear<Shape>(
+                                board_t, placement.orientation, placement.x, placement.y
+                        );
+
+                        state child{
+                                {},
+                                static_cast<uint8_t>(current.height - cleared_lines),
+                                static_cast<uint8_t>(current.next + 1 + choice.consumed_previews),
+                                choice.next_hold ? static_cast<uint8_t>(*choice.next_hold) : EmptyHold,
+                                static_cast<uint8_t>(current.placed + 1),
+                        };
+                        placed.copy_to(child.board.columns.data(), stdx::vector_aligned);
+
+                        if (!f(Move{Shape, placement, choice.choice == HoldChoice::Hold}, child)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                });
+                if (!proceed) {
+                    return;
+                }
+            }
+        }
+    };
+}
+
+BITRIS_ABI_END
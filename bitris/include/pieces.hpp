@@ -1,5 +1,9 @@
 #pragma once
 
+#include "abi.hpp"
+
+BITRIS_ABI_BEGIN
+
 enum class Shape {
     T = 0,
     I = 1,
@@ -21,3 +25,5 @@ struct Piece {
     Shape shape;
     Orientation orientation;
 };
+
+BITRIS_ABI_END
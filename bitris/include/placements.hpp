@@ -0,0 +1,95 @@
+#pragma once
+
+#include <bit>
+
+#include "abi.hpp"
+#include "pieces.hpp"
+#include "bits.hpp"
+#include "free_spaces.hpp"
+#include "canonical.hpp"
+
+BITRIS_ABI_BEGIN
+
+struct Placement {
+    Orientation orientation;
+    uint8_t x;
+    uint8_t y;
+
+    constexpr bool operator==(const Placement &) const = default;
+};
+
+template<typename Data, Shape Shape>
+struct placements {
+    using bits_t = bits<Data>;
+    static constexpr size_t N = free_spaces<Data, Shape>::N;
+    static constexpr size_t capacity = N * 10 * bits_t::bit_size;
+
+    static constexpr bool has_duplicates = canonical<Data, Shape>::has_duplicates;
+
+    struct list {
+        std::array<Placement, capacity> values;
+        size_t size;
+
+        [[nodiscard]] constexpr const Placement *begin() const {
+            return values.data();
+        }
+
+        [[nodiscard]] constexpr const Placement *end() const {
+            return values.data() + size;
+        }
+    };
+
+    // goalを置き場所の一覧に変換する
+    // Canonicalのとき、同じブロックを占める置き場所はNorth/Eastにまとめる
+    template<bool Canonical = true>
+    static constexpr list extract(const std::array<Data, N * 10> &goals) {
+        if constexpr (Canonical && has_duplicates) {
+            return extract_orientations<2>(canonicalize(goals));
+        } else {
+            return extract_orientations<N>(goals);
+        }
+    }
+
+    // South/Westのgoalを、同じブロックを占めるNorth/Eastのgoalに移す
+    static constexpr std::array<Data, N * 10> canonicalize(const std::array<Data, N * 10> &goals) {
+        using type = typename data<Data>::type;
+
+        std::array<type, N> all_goal{};
+        static_for<N>([&](const size_t Index) {
+            all_goal[Index].copy_from(&goals[Index * 10], stdx::element_aligned);
+        });
+
+        const auto folded = canonical<Data, Shape>::fold(all_goal);
+
+        std::array<Data, N * 10> result{};
+        static_for<N>([&](const size_t Index) {
+            folded[Index].copy_to(&result[Index * 10], stdx::element_aligned);
+        });
+        return result;
+    }
+
+private:
+    template<size_t Orientations>
+    static constexpr list extract_orientations(const std::array<Data, N * 10> &goals) {
+        list result;
+        size_t size = 0;
+        for (size_t orientation = 0; orientation < Orientations; ++orientation) {
+            for (size_t x = 0; x < 10; ++x) {
+                auto v = goals[orientation * 10 + x];
+                while (v) {
+                    const auto y = std::countr_zero(v);
+                    result.values[size++] = {
+                            static_cast<Orientation>(orientation),
+                            static_cast<uint8_t>(x),
+                            static_cast<uint8_t>(y),
+                    };
+                    v = static_cast<Data>(v & (v - 1));
+                }
+            }
+        }
+        result.size = size;
+        return result;
+    }
+};
+
+BITRIS_ABI_END
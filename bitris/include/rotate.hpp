@@ -3,11 +3,15 @@
 #include <cstddef>
 #include <utility>
 
+#include "abi.hpp"
 #include "pieces.hpp"
 
+BITRIS_ABI_BEGIN
+
 enum class Rotation {
     Cw = 0,
     Ccw = 1,
+    Flip = 2,
 };
 
 consteval Orientation rotate_to(const Orientation from, const Rotation rotation) {
@@ -17,6 +21,10 @@ consteval Orientation rotate_to(const Orientation from, const Rotation rotation)
             return static_cast<Orientation>((index + 1) % 4);
         case Rotation::Ccw:
             return static_cast<Orientation>((index + 3) % 4);
+        case Rotation::Flip:
+            return static_cast<Orientation>((index + 2) % 4);
     }
     std::unreachable();
 }
+
+BITRIS_ABI_END
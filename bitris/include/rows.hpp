@@ -1,7 +1,10 @@
 #pragma once
 
+#include "abi.hpp"
 #include "bits.hpp"
 
+BITRIS_ABI_BEGIN
+
 namespace rows {
     template<typename Data>
     inline int top_y(
@@ -19,3 +22,5 @@ namespace rows {
         return bits<Data>::most_significant_index(masked_used_rows);
     }
 }
+
+BITRIS_ABI_END
@@ -2,7 +2,10 @@
 
 #include <utility>
 #include <bitset>
+#include <span>
+#include <cassert>
 
+#include "abi.hpp"
 #include "rows.hpp"
 #include "pieces.hpp"
 #include "rotate.hpp"
@@ -11,37 +14,86 @@
 #include "free_spaces.hpp"
 #include "search_core.hpp"
 
+BITRIS_ABI_BEGIN
+
 namespace s {
-    template<typename Data, Shape Shape>
+    struct Spawn {
+        Orientation orientation;
+        uint8_t cx;
+        uint8_t cy;
+    };
+
+    // searcher::search_spinsの結果。並びはsearchのgoalと同じ
+    template<typename Data, size_t N>
+    struct SpinGoals {
+        std::array<Data, N * 10> goals;
+        // 最後の操作を回転にして到達できる位置
+        std::array<Data, N * 10> rotated;
+        // 左右・上に動かせない位置。rotatedと重なる位置がall-spinになる
+        std::array<Data, N * 10> immobile;
+        // Tのみ。3コーナーを満たすT-spin Miniと、T-spin
+        std::array<Data, N * 10> tspin_mini;
+        std::array<Data, N * 10> tspin;
+    };
+
+    // Canonicalのとき、同じブロックを占める向きをNorth/Eastにまとめたgoalを返す
+    // Movement::HardDropのとき、積まれたブロックより上で横移動・回転してハードドロップできる位置に限る
+    // Kicksで回転のキックテーブルを選ぶ (kicks.hpp)
+    template<
+        typename Data, Shape Shape, bool Canonical = false,
+        Movement Movement = Movement::Srs, typename Kicks = srs_kicks
+    >
     struct searcher {
         using data_t = data<Data>;
         using type = typename data_t::type;
         using AlignedBoard = data_t::AlignedBoard;
         static constexpr auto N = free_spaces<Data, Shape>::N;
 
-//    private:
-//        template<typename U>
-//        static constexpr std::array<Data, N * 10> search_casted(
-//                const AlignedBoard &board,
-//                const Orientation spawn_orientation,
-//                const uint8_t spawn_cx,
-//                const uint8_t spawn_cy
-//        ) {
-//            const auto board_u = data_t::template load<U>(board);
-//
-//            const auto goals = searcher<U, Shape>::execute(
-//                    board_u, spawn_orientation, spawn_cx, spawn_cy
-//            );
-//
-//            alignas(32) std::array<Data, N * 10> array{};
-//            static_for_t<N>([&]<size_t SrcIndex>() {
-//                const auto converted = data<U>::template to<Data>(goals[SrcIndex]);
-//                static_for_t<10>([&]<size_t DestIndex>() {
-//                    array[SrcIndex * 10 + DestIndex] = converted[DestIndex];
-//                });
-//            });
-//            return array;
-//        }
+        // search_batchで同時に探索する盤面の数
+        static constexpr size_t BatchLanes = 2;
+
+        // search_narrowedで、積まれたブロックの上に残す段数
+        // goalとそこへ移動するための空間はブロックの上5段に収まり、それより上は何もない空間として扱える
+        static constexpr size_t Headroom = 5;
+
+    private:
+        // 盤面をUに切り詰めて探索し、結果をDataに戻す
+        template<typename U>
+        static std::array<Data, N * 10> search_casted(
+                const AlignedBoard &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            alignas(data<U>::alignment) std::array<U, 10> columns{};
+            static_for<10>([&](const size_t Index) {
+                columns[Index] = static_cast<U>(board.columns[Index]);
+            });
+            const auto board_u = typename data<U>::type{columns.data(), stdx::vector_aligned};
+
+            const auto goals = searcher<U, Shape, Canonical, Movement, Kicks>::execute(
+                    board_u, spawn_orientation, spawn_cx, spawn_cy
+            );
+
+            alignas(32) std::array<Data, N * 10> array{};
+            static_for_t<N>([&]<size_t SrcIndex>() {
+                static_for_t<10>([&]<size_t DestIndex>() {
+                    array[SrcIndex * 10 + DestIndex] = static_cast<Data>(goals[SrcIndex][DestIndex]);
+                });
+            });
+            return array;
+        }
+
+        // 高さheightの盤面を、Uに切り詰めても同じ結果になるか
+        // spawnがUの範囲外のときは、積まれたブロックより上すべてがspawnの候補になる
+        template<typename U>
+        static constexpr bool is_narrowable(const size_t height, const uint8_t spawn_cy) {
+            constexpr auto bit_size = bits<U>::bit_size;
+            if (bit_size < height + Headroom) {
+                return false;
+            }
+            return bit_size <= spawn_cy || spawn_cy + Headroom <= bit_size;
+        }
 
     public:
         static constexpr std::array<Data, N * 10> search(
@@ -65,46 +117,261 @@ namespace s {
             return array;
         }
 
+        // 積まれたブロックの高さから、探索できる最も狭いDataを選んで探索する
+        // 結果はsearchと同じ
+        static std::array<Data, N * 10> search_narrowed(
+                const AlignedBoard &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            const auto used_rows = bits<Data>::used_rows(board.columns);
+            const auto height = static_cast<size_t>(bits<Data>::most_significant_index(used_rows) + 1);
+
+            if constexpr (bits<uint8_t>::bit_size < bits<Data>::bit_size) {
+                if (is_narrowable<uint8_t>(height, spawn_cy)) {
+                    return search_casted<uint8_t>(board, spawn_orientation, spawn_cx, spawn_cy);
+                }
+            }
+            if constexpr (bits<uint16_t>::bit_size < bits<Data>::bit_size) {
+                if (is_narrowable<uint16_t>(height, spawn_cy)) {
+                    return search_casted<uint16_t>(board, spawn_orientation, spawn_cx, spawn_cy);
+                }
+            }
+            if constexpr (bits<uint32_t>::bit_size < bits<Data>::bit_size) {
+                if (is_narrowable<uint32_t>(height, spawn_cy)) {
+                    return search_casted<uint32_t>(board, spawn_orientation, spawn_cx, spawn_cy);
+                }
+            }
+            if constexpr (bits<uint64_t>::bit_size < bits<Data>::bit_size) {
+                if (is_narrowable<uint64_t>(height, spawn_cy)) {
+                    return search_casted<uint64_t>(board, spawn_orientation, spawn_cx, spawn_cy);
+                }
+            }
+            return search(board, spawn_orientation, spawn_cx, spawn_cy);
+        }
+
+        // 複数の盤面をまとめて探索し、goalをoutに書き出す。outはboardsと同じ長さ以上が必要
+        // 同じ向きでspawnする盤面が連続する場合は、BatchLanes個ずつ交互に探索を進める
+        static void search_batch(
+                const std::span<const AlignedBoard> boards,
+                const std::span<const Spawn> spawns,
+                const std::span<std::array<Data, N * 10> > out
+        ) {
+            assert(boards.size() == spawns.size());
+            assert(boards.size() <= out.size());
+
+            size_t index = 0;
+            for (; index + BatchLanes <= boards.size(); index += BatchLanes) {
+                const auto spawn_orientation = spawns[index].orientation;
+
+                bool is_same_orientation = true;
+                std::array<type, BatchLanes> boards_t{};
+                std::array<uint8_t, BatchLanes> spawn_cxs{};
+                std::array<uint8_t, BatchLanes> spawn_cys{};
+                static_for<BatchLanes>([&](const size_t k) {
+                    const auto &spawn = spawns[index + k];
+                    is_same_orientation &= spawn.orientation == spawn_orientation;
+                    boards_t[k] = data_t::load(boards[index + k]);
+                    spawn_cxs[k] = spawn.cx;
+                    spawn_cys[k] = spawn.cy;
+                });
+
+                if (N == 1 || is_same_orientation) {
+                    const auto all_goals = execute_interleaved(boards_t, spawn_orientation, spawn_cxs, spawn_cys);
+                    static_for<BatchLanes>([&](const size_t k) {
+                        store(all_goals[k], out[index + k]);
+                    });
+                } else {
+                    static_for<BatchLanes>([&](const size_t k) {
+                        const auto &spawn = spawns[index + k];
+                        store(execute(boards_t[k], spawn.orientation, spawn.cx, spawn.cy), out[index + k]);
+                    });
+                }
+            }
+
+            for (; index < boards.size(); ++index) {
+                const auto &spawn = spawns[index];
+                const auto board_t = data_t::load(boards[index]);
+                store(execute(board_t, spawn.orientation, spawn.cx, spawn.cy), out[index]);
+            }
+        }
+
         static constexpr std::array<type, N> execute(
                 const type &board,
                 const Orientation spawn_orientation,
                 const uint8_t spawn_cx,
                 const uint8_t spawn_cy
         ) {
-            if constexpr (N == 1) {
-                constexpr auto orientation = Orientation::North;
-                return search_core::core_so<Data, Shape, orientation>::execute(
+            return dispatch(spawn_orientation, [&]<Orientation Orientation>() {
+                using core = search_core::core_so<Data, Shape, Orientation, Movement, Kicks>;
+                return core::template execute<Canonical>(
                         board, spawn_cx, spawn_cy
                 );
+            });
+        }
+
+        // goalと、スピンの判定を返す (search_core::spin_planes)
+        // スピンの判定には向きの区別が必要なため、Canonicalでは使えない
+        static constexpr search_core::spin_planes<Data, N> execute_with_spins(
+                const type &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            static_assert(!Canonical, "Spin detection needs distinct orientations.");
+            return dispatch(spawn_orientation, [&]<Orientation Orientation>() {
+                using core = search_core::core_so<Data, Shape, Orientation, Movement, Kicks>;
+                return core::execute_with_spins(board, spawn_cx, spawn_cy);
+            });
+        }
+
+        static SpinGoals<Data, N> search_spins(
+                const AlignedBoard &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            const auto spins = execute_with_spins(data_t::load(board), spawn_orientation, spawn_cx, spawn_cy);
+
+            SpinGoals<Data, N> result{};
+            store(spins.goal, result.goals);
+            store(spins.rotated, result.rotated);
+            store(spins.immobile, result.immobile);
+            store(spins.tspin_mini, result.tspin_mini);
+            store(spins.tspin, result.tspin);
+            return result;
+        }
+
+        static constexpr std::array<type, N> execute_from_free_spaces(
+                const std::array<type, N> &all_free_space,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            return dispatch(spawn_orientation, [&]<Orientation Orientation>() {
+                using core = search_core::core_so<Data, Shape, Orientation, Movement, Kicks>;
+                return core::template execute_from_free_spaces<Canonical>(
+                        all_free_space, spawn_cx, spawn_cy
+                );
+            });
+        }
+
+        static constexpr std::array<std::array<type, N>, BatchLanes> execute_interleaved(
+                const std::array<type, BatchLanes> &boards,
+                const Orientation spawn_orientation,
+                const std::array<uint8_t, BatchLanes> &spawn_cxs,
+                const std::array<uint8_t, BatchLanes> &spawn_cys
+        ) {
+            return dispatch(spawn_orientation, [&]<Orientation Orientation>() {
+                using core = search_core::core_so<Data, Shape, Orientation, Movement, Kicks>;
+                return core::template execute_interleaved<BatchLanes, Canonical>(
+                        boards, spawn_cxs, spawn_cys
+                );
+            });
+        }
+
+        // spawnの向きを定数に変換して、fを呼び出す
+        template<typename F>
+        [[gnu::always_inline]]
+        static constexpr auto dispatch(const Orientation spawn_orientation, F &&f) {
+            if constexpr (N == 1) {
+                return f.template operator()<Orientation::North>();
             }
 
             switch (spawn_orientation) {
-                case Orientation::North: {
-                    constexpr auto orientation = Orientation::North;
-                    return search_core::core_so<Data, Shape, orientation>::execute(
-                            board, spawn_cx, spawn_cy
-                    );
-                }
-                case Orientation::East: {
-                    constexpr auto orientation = Orientation::East;
-                    return search_core::core_so<Data, Shape, orientation>::execute(
-                            board, spawn_cx, spawn_cy
-                    );
-                }
-                case Orientation::South: {
-                    constexpr auto orientation = Orientation::South;
-                    return search_core::core_so<Data, Shape, orientation>::execute(
-                            board, spawn_cx, spawn_cy
-                    );
-                }
-                case Orientation::West: {
-                    constexpr auto orientation = Orientation::West;
-                    return search_core::core_so<Data, Shape, orientation>::execute(
-                            board, spawn_cx, spawn_cy
-                    );
-                }
+                case Orientation::North:
+                    return f.template operator()<Orientation::North>();
+                case Orientation::East:
+                    return f.template operator()<Orientation::East>();
+                case Orientation::South:
+                    return f.template operator()<Orientation::South>();
+                case Orientation::West:
+                    return f.template operator()<Orientation::West>();
             }
             std::unreachable();
         }
+
+    private:
+        [[gnu::always_inline]]
+        static void store(const std::array<type, N> &goals, std::array<Data, N * 10> &dest) {
+            static_for<N>([&](const size_t Index) {
+                goals[Index].copy_to(&dest[Index * 10], stdx::element_aligned);
+            });
+        }
     };
+
+    // 形を定数に変換して、fを呼び出す
+    template<typename F>
+    [[gnu::always_inline]]
+    constexpr auto dispatch_shape(const Shape shape, F &&f) {
+        switch (shape) {
+            case Shape::T:
+                return f.template operator()<Shape::T>();
+            case Shape::I:
+                return f.template operator()<Shape::I>();
+            case Shape::O:
+                return f.template operator()<Shape::O>();
+            case Shape::L:
+                return f.template operator()<Shape::L>();
+            case Shape::J:
+                return f.template operator()<Shape::J>();
+            case Shape::S:
+                return f.template operator()<Shape::S>();
+            case Shape::Z:
+                return f.template operator()<Shape::Z>();
+        }
+        std::unreachable();
+    }
+
+    // 実行時に決まる形で探索する
+    // Oは向きが1つのため、先頭の10列のみを使う
+    template<typename Data, bool Canonical = false>
+    constexpr std::array<Data, 4 * 10> search_shape(
+            const typename data<Data>::AlignedBoard &board,
+            const Shape shape,
+            const Spawn &spawn
+    ) {
+        std::array<Data, 4 * 10> result{};
+        dispatch_shape(shape, [&]<Shape Shape>() {
+            const auto goals = searcher<Data, Shape, Canonical>::search(
+                    board, spawn.orientation, spawn.cx, spawn.cy
+            );
+            std::copy(goals.begin(), goals.end(), result.begin());
+        });
+        return result;
+    }
+
+    // T, I, O, L, J, S, Zのすべての形をまとめて探索する
+    // 結果はShapeの値をインデックスとして格納する。Oは向きが1つのため、先頭の10列のみを使う
+    template<typename Data, bool Canonical = false>
+    constexpr std::array<std::array<Data, 4 * 10>, 7> search_all_shapes(
+            const typename data<Data>::AlignedBoard &board,
+            const Orientation spawn_orientation,
+            const uint8_t spawn_cx,
+            const uint8_t spawn_cy
+    ) {
+        using data_t = data<Data>;
+
+        const auto board_t = data_t::load(board);
+        const auto planes = free_space_planes<Data>::from(~board_t);
+
+        alignas(32) std::array<std::array<Data, 4 * 10>, 7> results{};
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            using searcher_t = searcher<Data, Shape, Canonical>;
+
+            const auto all_free_space = free_spaces<Data, Shape>::get(planes);
+            const auto goals = searcher_t::execute_from_free_spaces(
+                    all_free_space, spawn_orientation, spawn_cx, spawn_cy
+            );
+
+            auto &dest = results[static_cast<size_t>(Shape)];
+            static_for<searcher_t::N>([&](const size_t Index) {
+                goals[Index].copy_to(&dest[Index * 10], stdx::element_aligned);
+            });
+        });
+        return results;
+    }
 }
+
+BITRIS_ABI_END
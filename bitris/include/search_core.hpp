@@ -1,17 +1,31 @@
 #pragma once
 
+#include <bit>
 #include <utility>
 #include <bitset>
+#include <algorithm>
 
+#include "abi.hpp"
 #include "rows.hpp"
 #include "pieces.hpp"
 #include "rotate.hpp"
 #include "kicks.hpp"
 #include "data.hpp"
 #include "free_spaces.hpp"
+#include "canonical.hpp"
+
+BITRIS_ABI_BEGIN
+
+// 到達できる位置の探索方法
+enum class Movement {
+    // SRSの移動・回転・ソフトドロップをすべて使う
+    Srs = 0,
+    // 積まれたブロックより上で横移動・回転してから、ハードドロップする
+    HardDrop = 1,
+};
 
 namespace search_core {
-    template<typename Data, Shape Shape, Orientation Orientation, Rotation Rotation>
+    template<typename Data, Shape Shape, Orientation Orientation, Rotation Rotation, typename Kicks = srs_kicks>
     struct core_sor {
         using data_t = data<Data>;
         using type = typename data_t::type;
@@ -24,67 +38,71 @@ namespace search_core {
             auto src_candidates = src_reachable;
             auto dest_reachable = data_t::make_zero();
 
-            constexpr auto offsets = get_offsets<{Shape, Orientation}, Rotation>();
-            static_assert(offsets.size() == 5);
+            constexpr auto offsets = Kicks::template get<{Shape, Orientation}, Rotation>();
+            constexpr auto size = offsets.size();
 
-            do {
-                // offset[0]
-                {
-                    constexpr auto offset = offsets[0];
-                    const auto shift_forward = data_t::template shift<offset>(src_candidates);
-                    dest_reachable = dest_reachable | shift_forward;
-                    const auto shift_backward = data_t::template shift<-offset>(dest_free_space);
-                    src_candidates = (~shift_backward) & src_candidates;
-                    if (data_t::is_equal_to(src_candidates, 0)) {
-                        break;
-                    }
-                }
-                // offset[1]
-                {
-                    constexpr auto offset = offsets[1];
-                    const auto shift_forward = data_t::template shift<offset>(src_candidates);
-                    dest_reachable = dest_reachable | shift_forward;
-                    const auto shift_backward = data_t::template shift<-offset>(dest_free_space);
-                    src_candidates = (~shift_backward) & src_candidates;
-                    if (data_t::is_equal_to(src_candidates, 0)) {
-                        break;
-                    }
-                }
-                // offset[2]
-                {
-                    constexpr auto offset = offsets[2];
+            // offsetを順に試し、回転できなかった位置だけを次のoffsetに回す
+            // すべての位置で回転できた時点で打ち切る
+            [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+                (... && [&]<size_t Index>() {
+                    constexpr auto offset = offsets[Index];
                     const auto shift_forward = data_t::template shift<offset>(src_candidates);
                     dest_reachable = dest_reachable | shift_forward;
-                    const auto shift_backward = data_t::template shift<-offset>(dest_free_space);
-                    src_candidates = (~shift_backward) & src_candidates;
-                    if (data_t::is_equal_to(src_candidates, 0)) {
-                        break;
-                    }
-                }
-                // offset[3]
-                {
-                    constexpr auto offset = offsets[3];
-                    const auto shift_forward = data_t::template shift<offset>(src_candidates);
-                    dest_reachable = dest_reachable | shift_forward;
-                    const auto shift_backward = data_t::template shift<-offset>(dest_free_space);
-                    src_candidates = (~shift_backward) & src_candidates;
-                    if (data_t::is_equal_to(src_candidates, 0)) {
-                        break;
+                    if constexpr (Index + 1 < size) {
+                        const auto shift_backward = data_t::template shift<-offset>(dest_free_space);
+                        src_candidates = (~shift_backward) & src_candidates;
+                        return !data_t::is_equal_to(src_candidates, 0);
+                    } else {
+                        return false;
                     }
-                }
-                // offset[4]
-                {
-                    constexpr auto offset = offsets[4];
-                    const auto shift_forward = data_t::template shift<offset>(src_candidates);
-                    dest_reachable = dest_reachable | shift_forward;
-                }
-            } while (false);
+                }.template operator()<Indices>());
+            }(std::make_index_sequence<size>());
 
             return dest_reachable & dest_free_space;
         };
+
+        // rotateと同じ順にoffsetを試し、Index番目のoffsetで回転した位置を返す
+        template<size_t Index>
+        [[gnu::always_inline]]
+        static constexpr type rotate_by(
+                const type &src_reachable,
+                const type &dest_free_space
+        ) {
+            constexpr auto offsets = Kicks::template get<{Shape, Orientation}, Rotation>();
+            static_assert(Index < offsets.size());
+
+            auto src_candidates = src_reachable;
+            static_for_t<Index>([&]<size_t Prior>() {
+                constexpr auto offset = offsets[Prior];
+                src_candidates = ~data_t::template shift<-offset>(dest_free_space) & src_candidates;
+            });
+
+            constexpr auto offset = offsets[Index];
+            return data_t::template shift<offset>(src_candidates) & dest_free_space;
+        }
+    };
+
+    // goalごとの、スピンの判定
+    // 各平面はgoalと同じ並びで、goalに含まれる位置だけが1になる
+    template<typename Data, size_t N>
+    struct spin_planes {
+        using type = typename data<Data>::type;
+
+        std::array<type, N> goal;
+        // 最後の操作を回転にして到達できる位置
+        std::array<type, N> rotated;
+        // 左右・上に動かせない位置。rotatedと合わせて、all-spinの判定に使う
+        std::array<type, N> immobile;
+        // 3コーナーを満たすTの位置のうち、T-spin Mini。T以外は0
+        std::array<type, N> tspin_mini;
+        // 3コーナーを満たすTの位置のうち、T-spin (Miniを除く)。T以外は0
+        std::array<type, N> tspin;
     };
 
-    template<typename Data, Shape Shape, Orientation Orientation_>
+    template<
+        typename Data, Shape Shape, Orientation Orientation_,
+        Movement Movement = Movement::Srs, typename Kicks = srs_kicks
+    >
     struct core_so {
         using bits_t = bits<Data>;
         using data_t = data<Data>;
@@ -129,6 +147,10 @@ namespace search_core {
             std::unreachable();
         }
 
+        // 1周ごとに呼ばれる処理の本体。移動・回転・シフトをすべて展開する
+        // 多くの形・型をまとめてビルドする場合(src/search_kernels.cpp)でも、インライン化の上限で遅くならないようにする
+        // 呼び出し側に展開されるとflattenが効かなくなるため、この関数自体はインライン化しない
+        [[gnu::flatten, gnu::noinline]]
         static constexpr void move_and_rotate(
                 std::bitset<N> &needs_update,
                 const std::array<type, N> &all_free_space,
@@ -143,14 +165,9 @@ namespace search_core {
             needs_update.reset(current_index);
 
             // move
-            while (true) {
-                const auto &reachable = all_reachable[current_index];
-                const auto next = move(reachable, all_free_space[current_index]);
-                if (data_t::is_equal_to(next, reachable)) {
-                    break;
-                }
-                all_reachable[current_index] = next;
-            }
+            all_reachable[current_index] = move_closure(
+                    all_reachable[current_index], all_free_space[current_index]
+            );
 
             // rotate
             const auto reachable_for_rotate = all_reachable[current_index] &
@@ -159,36 +176,80 @@ namespace search_core {
             rotated_already[current_index] |= reachable_for_rotate;
 
             // rotate cw
-            {
-                constexpr auto rotation = Rotation::Cw;
-                constexpr auto to_orientation = rotate_to(Orientation_, rotation);
-                constexpr auto dest_orientation_index = static_cast<size_t>(to_orientation);
-
-                const auto found_dest_reachable = search_core::core_sor<Data, Shape, Orientation_, rotation>::rotate(
-                        reachable_for_rotate, all_free_space[dest_orientation_index]
-                );
+            rotate_and_update<Rotation::Cw>(needs_update, all_free_space, all_reachable, reachable_for_rotate);
+            // rotate ccw
+            rotate_and_update<Rotation::Ccw>(needs_update, all_free_space, all_reachable, reachable_for_rotate);
+            // rotate 180
+            if constexpr (Kicks::has_flip) {
+                rotate_and_update<Rotation::Flip>(needs_update, all_free_space, all_reachable, reachable_for_rotate);
+            }
+        }
 
-                const auto dest_reachable = all_reachable[dest_orientation_index] | found_dest_reachable;
-                if (data_t::is_not_equal_to(all_reachable[dest_orientation_index], dest_reachable)) {
-                    all_reachable[dest_orientation_index] = dest_reachable;
-                    needs_update.set(dest_orientation_index);
-                }
+        template<size_t K>
+        [[gnu::flatten, gnu::noinline]]
+        static constexpr void move_and_rotate_interleaved(
+                std::array<std::bitset<N>, K> &needs_update,
+                const std::array<std::array<type, N>, K> &all_free_space,
+                std::array<std::array<type, N>, K> &all_reachable,
+                std::array<std::array<type, N>, K> &rotated_already
+        ) {
+            // check
+            // どれか1つでも更新が必要なら、すべての盤面をまとめて進める。
+            // 更新が不要な盤面は既に収束しているため、移動・回転しても結果は変わらない
+            constexpr auto current_index = static_cast<size_t>(Orientation_);
+            bool any = false;
+            static_for<K>([&](const size_t k) {
+                any |= needs_update[k][current_index];
+                needs_update[k].reset(current_index);
+            });
+            if (!any) {
+                return;
             }
-            // rotate ccw
-            {
-                constexpr auto rotation = Rotation::Ccw;
-                constexpr auto to_orientation = rotate_to(Orientation_, rotation);
-                constexpr auto dest_orientation_index = static_cast<size_t>(to_orientation);
 
-                const auto found_dest_reachable = search_core::core_sor<Data, Shape, Orientation_, rotation>::rotate(
-                        reachable_for_rotate, all_free_space[dest_orientation_index]
-                );
+            // move
+            move_closure_interleaved<K>(all_free_space, all_reachable, current_index);
 
-                const auto dest_reachable = all_reachable[dest_orientation_index] | found_dest_reachable;
-                if (data_t::is_not_equal_to(all_reachable[dest_orientation_index], dest_reachable)) {
-                    all_reachable[dest_orientation_index] = dest_reachable;
-                    needs_update.set(dest_orientation_index);
+            // rotate
+            static_for<K>([&](const size_t k) {
+                const auto reachable_for_rotate = all_reachable[k][current_index] &
+                                                  data_t::template make_square<(bits<Data>::full >> 2)>() &
+                                                  ~rotated_already[k][current_index];
+                rotated_already[k][current_index] |= reachable_for_rotate;
+
+                rotate_and_update<Rotation::Cw>(
+                        needs_update[k], all_free_space[k], all_reachable[k], reachable_for_rotate
+                );
+                rotate_and_update<Rotation::Ccw>(
+                        needs_update[k], all_free_space[k], all_reachable[k], reachable_for_rotate
+                );
+                if constexpr (Kicks::has_flip) {
+                    rotate_and_update<Rotation::Flip>(
+                            needs_update[k], all_free_space[k], all_reachable[k], reachable_for_rotate
+                    );
                 }
+            });
+        }
+
+        template<Rotation Rotation>
+        [[gnu::always_inline]]
+        static constexpr void rotate_and_update(
+                std::bitset<N> &needs_update,
+                const std::array<type, N> &all_free_space,
+                std::array<type, N> &all_reachable,
+                const type &reachable_for_rotate
+        ) {
+            constexpr auto to_orientation = rotate_to(Orientation_, Rotation);
+            constexpr auto dest_orientation_index = static_cast<size_t>(to_orientation);
+
+            using core = search_core::core_sor<Data, Shape, Orientation_, Rotation, Kicks>;
+            const auto found_dest_reachable = core::rotate(
+                    reachable_for_rotate, all_free_space[dest_orientation_index]
+            );
+
+            const auto dest_reachable = all_reachable[dest_orientation_index] | found_dest_reachable;
+            if (data_t::is_not_equal_to(all_reachable[dest_orientation_index], dest_reachable)) {
+                all_reachable[dest_orientation_index] = dest_reachable;
+                needs_update.set(dest_orientation_index);
             }
         }
 
@@ -206,52 +267,358 @@ namespace search_core {
             }
         }
 
+        // 高い盤面では、全体を毎回広げるより、新しく到達した位置(frontier)だけを動かすほうが速い
+        // 下へは7段までまとめて落とし、残りは次の回で落とす
+        static constexpr bool UsesFrontier = 32 < bits_t::bit_size;
+        static constexpr size_t FillDownSteps = 3;
+
+        // frontierを横に動かし、下へ落とす。新しく到達した位置を返す
+        // reachableは、すでにfrontierを含んでいる
+        [[gnu::always_inline]]
+        static constexpr type move_frontier(type &reachable, const type &frontier, const type &free_space) {
+            const auto right = data_t::template shift_right<1>(frontier);
+            const auto left = data_t::template shift_left<1>(frontier);
+            const auto next = (right | left | data_t::template shift_down<1>(frontier)) & free_space & ~reachable;
+            const auto dropped = data_t::template fill_down<FillDownSteps>(next, free_space) & ~reachable;
+            reachable |= dropped;
+            return dropped;
+        }
+
+        // Canonicalのとき、同じブロックを占める向き(S, Z, IのSouth/West)をNorth/Eastにまとめる
+        // 向きを区別する必要がある場合(スピン判定など)はfalseのままにする
+        template<bool Canonical = false>
         static constexpr std::array<type, N> execute(
                 const type &board,
                 const uint8_t spawn_cx,
                 const uint8_t spawn_cy
         ) {
-            static_assert(N == 1 || N == 4);
-
             const auto free_space_block = ~board;
             const auto all_free_space = free_spaces<Data, Shape>::get(free_space_block);
+            if constexpr (Movement == Movement::HardDrop) {
+                return lock<Canonical>(all_free_space, hard_drop(board, all_free_space, spawn_cx, spawn_cy));
+            } else {
+                return execute_from_free_spaces<Canonical>(all_free_space, spawn_cx, spawn_cy);
+            }
+        }
 
-            auto all_reachable = spawn(all_free_space, spawn_cx, spawn_cy);
-            auto rotated_already = std::array<type, N>{};
+        // 形ごとの空白を計算済みの場合に使う
+        template<bool Canonical = false>
+        static constexpr std::array<type, N> execute_from_free_spaces(
+                const std::array<type, N> &all_free_space,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            static_assert(Movement == Movement::Srs, "HardDrop needs the board. Use execute instead.");
+            return lock<Canonical>(all_free_space, reach(all_free_space, spawn_cx, spawn_cy));
+        }
+
+        // goalと、スピンの判定を返す
+        // 探索は変えずに、到達できる位置から回転をもう一度だけ試して、回転で到達できる位置を求める
+        static constexpr spin_planes<Data, N> execute_with_spins(
+                const type &board,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            static_assert(Movement == Movement::Srs, "HardDrop never ends with a rotation.");
+
+            const auto planes = free_space_planes<Data>::from(~board);
+            const auto all_free_space = free_spaces<Data, Shape>::get(planes);
+            return spins(planes, all_free_space, reach(all_free_space, spawn_cx, spawn_cy));
+        }
+
+        // spawnから移動・回転で到達できる位置
+        static constexpr std::array<type, N> reach(
+                const std::array<type, N> &all_free_space,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            return reach_from(
+                    all_free_space, spawn(all_free_space, spawn_cx, spawn_cy), {}, [](const auto &) {}
+            );
+        }
+
+        // all_reachableから移動・回転で到達できる位置
+        // rotated_alreadyには、回転先がall_reachableに含まれている位置を渡す
+        // 移動・回転を1周するごとに、その時点で到達できる位置をon_roundに渡す
+        template<typename F>
+        static constexpr std::array<type, N> reach_from(
+                const std::array<type, N> &all_free_space,
+                std::array<type, N> all_reachable,
+                [[maybe_unused]] std::array<type, N> rotated_already,
+                F &&on_round
+        ) {
+            static_assert(N == 1 || N == 4);
 
             if constexpr (N == 4) {
                 auto needs_update = std::bitset<N>().flip();
                 while (needs_update.any()) {
                     static_for_t<orientation_order()>(
                             [&]<Orientation Orientation2>() {
-                                core_so<Data, Shape, Orientation2>::move_and_rotate(
+                                core_so<Data, Shape, Orientation2, Movement, Kicks>::move_and_rotate(
                                         needs_update, all_free_space, all_reachable, rotated_already
                                 );
                             });
+                    on_round(all_reachable);
                 }
             } else {
-                constexpr size_t index = 0;
+                all_reachable[0] = move_closure(all_reachable[0], all_free_space[0]);
+                on_round(all_reachable);
+            }
 
-                // move
+            return all_reachable;
+        }
+
+        // 移動だけで到達できる位置
+        [[gnu::always_inline]]
+        static constexpr type move_closure(const type &reachable, const type &free_space) {
+            if constexpr (UsesFrontier) {
+                auto closure = data_t::template fill_down<FillDownSteps>(reachable, free_space);
+                auto frontier = closure;
+                while (data_t::is_not_equal_to(frontier, 0)) {
+                    frontier = move_frontier(closure, frontier, free_space);
+                }
+                return closure;
+            } else {
+                auto closure = reachable;
                 while (true) {
-                    const auto &reachable = all_reachable[index];
-                    const auto next = move(reachable, all_free_space[index]);
+                    const auto next = move(closure, free_space);
+                    if (data_t::is_equal_to(next, closure)) {
+                        return closure;
+                    }
+                    closure = next;
+                }
+            }
+        }
+
+        // K個の盤面のindexの向きについて、移動だけで到達できる位置を同時に求める
+        // 盤面ごとの依存チェーンを交互に並べて、レイテンシを隠蔽する
+        template<size_t K>
+        [[gnu::always_inline]]
+        static constexpr void move_closure_interleaved(
+                const std::array<std::array<type, N>, K> &all_free_space,
+                std::array<std::array<type, N>, K> &all_reachable,
+                const size_t index
+        ) {
+            if constexpr (UsesFrontier) {
+                std::array<type, K> frontiers{};
+                static_for<K>([&](const size_t k) {
+                    all_reachable[k][index] = data_t::template fill_down<FillDownSteps>(
+                            all_reachable[k][index], all_free_space[k][index]
+                    );
+                    frontiers[k] = all_reachable[k][index];
+                });
 
-                    if (data_t::is_equal_to(next, reachable)) {
+                while (true) {
+                    bool updated = false;
+                    static_for<K>([&](const size_t k) {
+                        frontiers[k] = move_frontier(all_reachable[k][index], frontiers[k], all_free_space[k][index]);
+                        updated |= data_t::is_not_equal_to(frontiers[k], 0);
+                    });
+                    if (!updated) {
                         break;
                     }
-                    all_reachable[index] = next;
                 }
+            } else {
+                while (true) {
+                    bool updated = false;
+                    static_for<K>([&](const size_t k) {
+                        const auto &reachable = all_reachable[k][index];
+                        const auto next = move(reachable, all_free_space[k][index]);
+                        updated |= data_t::is_not_equal_to(next, reachable);
+                        all_reachable[k][index] = next;
+                    });
+                    if (!updated) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        // K個の盤面を同時に探索する。結果はexecuteをK回呼んだ場合と同じ
+        template<size_t K, bool Canonical = false>
+        static constexpr std::array<std::array<type, N>, K> execute_interleaved(
+                const std::array<type, K> &boards,
+                const std::array<uint8_t, K> &spawn_cxs,
+                const std::array<uint8_t, K> &spawn_cys
+        ) {
+            static_assert(N == 1 || N == 4);
+
+            if constexpr (Movement == Movement::HardDrop) {
+                std::array<std::array<type, N>, K> all_goal{};
+                static_for<K>([&](const size_t k) {
+                    all_goal[k] = execute<Canonical>(boards[k], spawn_cxs[k], spawn_cys[k]);
+                });
+                return all_goal;
+            }
+
+            auto all_free_space = std::array<std::array<type, N>, K>{};
+            auto all_reachable = std::array<std::array<type, N>, K>{};
+            static_for<K>([&](const size_t k) {
+                all_free_space[k] = free_spaces<Data, Shape>::get(~boards[k]);
+                all_reachable[k] = spawn(all_free_space[k], spawn_cxs[k], spawn_cys[k]);
+            });
+
+            if constexpr (N == 4) {
+                auto rotated_already = std::array<std::array<type, N>, K>{};
+                auto needs_update = std::array<std::bitset<N>, K>{};
+                for (auto &flags: needs_update) {
+                    flags.set();
+                }
+
+                const auto any = [&]() {
+                    bool result = false;
+                    static_for<K>([&](const size_t k) {
+                        result |= needs_update[k].any();
+                    });
+                    return result;
+                };
+
+                while (any()) {
+                    static_for_t<orientation_order()>(
+                            [&]<Orientation Orientation2>() {
+                                core_so<Data, Shape, Orientation2, Movement, Kicks>::template move_and_rotate_interleaved<K>(
+                                        needs_update, all_free_space, all_reachable, rotated_already
+                                );
+                            });
+                }
+            } else {
+                // move
+                move_closure_interleaved<K>(all_free_space, all_reachable, 0);
             }
 
-            // lock
-            {
-                std::array<type, N> all_goal{};
+            std::array<std::array<type, N>, K> all_goal{};
+            static_for<K>([&](const size_t k) {
+                all_goal[k] = lock<Canonical>(all_free_space[k], all_reachable[k]);
+            });
+            return all_goal;
+        }
+
+        // 積まれたブロックより上で移動・回転できる位置を求め、そこから真下に落とした位置を返す
+        static constexpr std::array<type, N> hard_drop(
+                const type &board,
+                const std::array<type, N> &all_free_space,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            // 最も高いブロックから下をすべて埋めた盤面で、移動できる範囲を求める
+            const auto used_rows = static_fold_t<10>([&]<size_t Index>(const auto acc) {
+                return static_cast<Data>(acc | board[Index]);
+            }, bits_t::zero);
+            const auto top = bits_t::most_significant_index(used_rows);
+            const auto floor_rows = 0 <= top ? static_cast<Data>(bits_t::full >> (bits_t::bit_size - 1 - top)) : 0;
+            const auto floor_free_space = free_spaces<Data, Shape>::get(~data_t::make_square(floor_rows));
+
+            auto all_reachable = reach(floor_free_space, spawn_cx, spawn_cy);
+            static_for<N>([&](const size_t Index) {
+                all_reachable[Index] = drop(all_reachable[Index], all_free_space[Index]);
+            });
+            return all_reachable;
+        }
+
+        // 各列について、reachableの最も低い位置から下に空白が続く範囲の一番下を返す
+        [[gnu::always_inline]]
+        static constexpr type drop(const type &reachable, const type &free_space) {
+            const auto lowest = reachable & -reachable;
+
+            // lowestより下のブロック。reachableがない列はあとで除く
+            const auto below = lowest - 1;
+            auto blocked = ~free_space & below;
+
+            // 最も高いブロックから下をすべて1にする
+            static_for<std::bit_width(bits_t::bit_size) - 1>([&](const size_t index) {
+                blocked |= blocked >> (1 << index);
+            });
+
+            const auto fall = (lowest | below) & ~blocked;
+            auto landing = fall & ~(fall << 1);
+            stdx::where(reachable == 0, landing) = 0;
+            return landing;
+        }
+
+        // 到達できる位置から、goalとスピンの判定をビット平面のまま求める
+        // 壁・床はブロックとみなし、天井より上は空いているとみなす
+        static constexpr spin_planes<Data, N> spins(
+                const free_space_planes<Data> &planes,
+                const std::array<type, N> &all_free_space,
+                const std::array<type, N> &all_reachable
+        ) {
+            spin_planes<Data, N> result{};
+            result.goal = lock<false>(all_free_space, all_reachable);
+
+            // Tが最後のキック(1x2)で回転した位置。3コーナーを満たせば、Miniにならない
+            [[maybe_unused]] std::array<type, N> last_kick{};
+
+            if constexpr (N == 4) {
+                static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                        [&]<Orientation From>() {
+                            // 探索と同じく、上2段からは回転しない
+                            const auto sources = all_reachable[static_cast<size_t>(From)] &
+                                                 data_t::template make_square<(bits_t::full >> 2)>();
+
+                            static_for_t<{Rotation::Cw, Rotation::Ccw, Rotation::Flip}>([&]<Rotation Rotation>() {
+                                if constexpr (Rotation != Rotation::Flip || Kicks::has_flip) {
+                                    constexpr auto to_index = static_cast<size_t>(rotate_to(From, Rotation));
+                                    using core = core_sor<Data, Shape, From, Rotation, Kicks>;
+                                    const auto &dest_free_space = all_free_space[to_index];
+
+                                    result.rotated[to_index] |= core::rotate(sources, dest_free_space);
+                                    if constexpr (Shape == Shape::T && Rotation != Rotation::Flip) {
+                                        last_kick[to_index] |= core::template rotate_by<4>(sources, dest_free_space);
+                                    }
+                                }
+                            });
+                        });
+            }
+
+            static_for<N>([&](const size_t Index) {
+                const auto &free_space = all_free_space[Index];
+                result.rotated[Index] &= result.goal[Index];
+                result.immobile[Index] = result.goal[Index] &
+                                         ~data_t::template shift_left<1>(free_space) &
+                                         ~data_t::template shift_right<1>(free_space) &
+                                         ~data_t::template shift_down<1, true>(free_space);
+            });
+
+            if constexpr (Shape == Shape::T) {
+                // 回転中心から斜めのマスが埋まっているか
+                const auto ne = ~planes.d1l1;
+                const auto nw = ~planes.d1r1;
+                const auto se = ~planes.u1l1;
+                const auto sw = ~planes.u1r1;
+                const auto three_corners = (ne & nw & (se | sw)) | (se & sw & (ne | nw));
+
+                // Tの凸側の2つのコーナー
+                const std::array<type, N> front{ne & nw, ne & se, se & sw, nw & sw};
+
                 static_for<N>([&](const size_t Index) {
-                    all_goal[Index] = ~data_t::template shift_up<1>(all_free_space[Index]) & all_reachable[Index];
+                    const auto spin = result.rotated[Index] & three_corners;
+                    result.tspin[Index] = spin & (front[Index] | last_kick[Index]);
+                    result.tspin_mini[Index] = spin & ~result.tspin[Index];
                 });
+            }
+
+            return result;
+        }
+
+        // 下にブロックがあり、その場で固定できる位置をgoalとする
+        template<bool Canonical>
+        [[gnu::always_inline]]
+        static constexpr std::array<type, N> lock(
+                const std::array<type, N> &all_free_space,
+                const std::array<type, N> &all_reachable
+        ) {
+            std::array<type, N> all_goal{};
+            static_for<N>([&](const size_t Index) {
+                all_goal[Index] = ~data_t::template shift_up<1>(all_free_space[Index]) & all_reachable[Index];
+            });
+
+            if constexpr (Canonical) {
+                return canonical<Data, Shape>::fold(all_goal);
+            } else {
                 return all_goal;
             }
         }
     };
 }
+
+BITRIS_ABI_END
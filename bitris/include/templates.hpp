@@ -1,5 +1,9 @@
 #pragma once
 
+#include "abi.hpp"
+
+BITRIS_ABI_BEGIN
+
 template<std::size_t iterations, typename F>
 constexpr void static_for(F &&function) {
     constexpr auto f = []<std::size_t... S>(F &&callable, std::index_sequence<S...>) {
@@ -63,3 +67,5 @@ constexpr std::array<T, N> static_zip2(F &&function, const std::array<T, N> &arr
     f(std::forward<F>(function), buffer, arr1, arr2, std::make_index_sequence<N>());
     return buffer;
 }
+
+BITRIS_ABI_END
@@ -0,0 +1,91 @@
+#include "bitris.h"
+#include "dispatch.hpp"
+#include "kernels.hpp"
+
+// C API (bitris.h)。引数を確かめてから、起動時に選んだカーネルを呼び出す
+namespace {
+    bool is_valid(const uint8_t shape) {
+        return shape <= static_cast<uint8_t>(Shape::Z);
+    }
+
+    bool is_valid(const uint8_t orientation, const uint8_t cx) {
+        return orientation <= static_cast<uint8_t>(Orientation::West) && cx < 10;
+    }
+
+    template<typename Data>
+    int search(
+            const Data *board,
+            const uint8_t shape,
+            const uint8_t orientation,
+            const uint8_t cx,
+            const uint8_t cy,
+            Data *out
+    ) {
+        if (board == nullptr || out == nullptr || !is_valid(shape) || !is_valid(orientation, cx)) {
+            return BITRIS_ERROR_INVALID_ARGUMENT;
+        }
+        bitris_isa::selected_kernels().get<Data>().search(board, shape, orientation, cx, cy, out);
+        return BITRIS_OK;
+    }
+
+    template<typename Data>
+    int search_batch(
+            const Data *boards,
+            const bitris_spawn *spawns,
+            const size_t count,
+            const uint8_t shape,
+            Data *out
+    ) {
+        if (count == 0) {
+            return BITRIS_OK;
+        }
+        if (boards == nullptr || spawns == nullptr || out == nullptr || !is_valid(shape)) {
+            return BITRIS_ERROR_INVALID_ARGUMENT;
+        }
+        for (size_t index = 0; index < count; ++index) {
+            if (!is_valid(spawns[index].orientation, spawns[index].cx)) {
+                return BITRIS_ERROR_INVALID_ARGUMENT;
+            }
+        }
+        bitris_isa::selected_kernels().get<Data>().search_batch(boards, spawns, count, shape, out);
+        return BITRIS_OK;
+    }
+}
+
+extern "C" {
+    const char *bitris_isa_level(void) {
+        return s::isa_level_name(s::selected_isa_level());
+    }
+
+    int bitris_search_u8(const uint8_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint8_t *out) {
+        return search(board, shape, orientation, cx, cy, out);
+    }
+
+    int bitris_search_u16(const uint16_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint16_t *out) {
+        return search(board, shape, orientation, cx, cy, out);
+    }
+
+    int bitris_search_u32(const uint32_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint32_t *out) {
+        return search(board, shape, orientation, cx, cy, out);
+    }
+
+    int bitris_search_u64(const uint64_t *board, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, uint64_t *out) {
+        return search(board, shape, orientation, cx, cy, out);
+    }
+
+    int bitris_search_batch_u8(const uint8_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint8_t *out) {
+        return search_batch(boards, spawns, count, shape, out);
+    }
+
+    int bitris_search_batch_u16(const uint16_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint16_t *out) {
+        return search_batch(boards, spawns, count, shape, out);
+    }
+
+    int bitris_search_batch_u32(const uint32_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint32_t *out) {
+        return search_batch(boards, spawns, count, shape, out);
+    }
+
+    int bitris_search_batch_u64(const uint64_t *boards, const bitris_spawn *spawns, size_t count, uint8_t shape, uint64_t *out) {
+        return search_batch(boards, spawns, count, shape, out);
+    }
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "dispatch.hpp"
+#include "kernels.hpp"
+
+namespace s {
+    namespace {
+        const bitris_isa::kernels &kernels_of(const IsaLevel level) {
+            switch (level) {
+                case IsaLevel::X86_64_V4:
+                    return bitris_isa::kernels_v4;
+                case IsaLevel::X86_64_V3:
+                    return bitris_isa::kernels_v3;
+                default:
+                    return bitris_isa::kernels_v2;
+            }
+        }
+
+        IsaLevel detect_isa_level() {
+            // 静的変数の初期化から呼ぶため、cpuidの結果を先に読み込んでおく
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("x86-64-v4")) {
+                return IsaLevel::X86_64_V4;
+            }
+            if (__builtin_cpu_supports("x86-64-v3")) {
+                return IsaLevel::X86_64_V3;
+            }
+            return IsaLevel::X86_64_V2;
+        }
+
+        template<typename Data>
+        std::array<Data, 4 * 10> search_with(
+                const bitris_isa::kernels &kernels,
+                const std::array<Data, 10> &board,
+                const Shape shape,
+                const Spawn &spawn
+        ) {
+            std::array<Data, 4 * 10> result{};
+            kernels.get<Data>().search(
+                    board.data(), static_cast<uint8_t>(shape), static_cast<uint8_t>(spawn.orientation),
+                    spawn.cx, spawn.cy, result.data()
+            );
+            return result;
+        }
+    }
+
+    const char *isa_level_name(const IsaLevel level) {
+        switch (level) {
+            case IsaLevel::X86_64_V4:
+                return "x86-64-v4";
+            case IsaLevel::X86_64_V3:
+                return "x86-64-v3";
+            default:
+                return "x86-64-v2";
+        }
+    }
+
+    bool is_supported(const IsaLevel level) {
+        return static_cast<int>(level) <= static_cast<int>(selected_isa_level());
+    }
+
+    IsaLevel selected_isa_level() {
+        // 他の静的変数の初期化からも呼べるよう、最初の呼び出しで一度だけ選ぶ
+        static const IsaLevel level = detect_isa_level();
+        return level;
+    }
+
+    template<typename Data>
+    std::array<Data, 4 * 10> dispatch_search(const std::array<Data, 10> &board, const Shape shape, const Spawn &spawn) {
+        return search_with(bitris_isa::selected_kernels(), board, shape, spawn);
+    }
+
+    template<typename Data>
+    std::array<Data, 4 * 10> dispatch_search(
+            const IsaLevel level,
+            const std::array<Data, 10> &board,
+            const Shape shape,
+            const Spawn &spawn
+    ) {
+        assert(is_supported(level));
+        return search_with(kernels_of(level), board, shape, spawn);
+    }
+
+    template<typename Data>
+    void dispatch_search_batch(
+            const std::span<const std::array<Data, 10> > boards,
+            const std::span<const Spawn> spawns,
+            const Shape shape,
+            const std::span<std::array<Data, 4 * 10> > out
+    ) {
+        assert(boards.size() == spawns.size());
+        assert(boards.size() <= out.size());
+        if (boards.empty()) {
+            return;
+        }
+
+        // カーネルはC APIと同じbitris_spawnを受け取るため、まとめて詰め替えてから1回で渡す
+        // 盤面を揃えて探索する単位への分割は、カーネルの中で行う
+        std::vector<bitris_spawn> kernel_spawns(spawns.size());
+        std::ranges::transform(spawns, kernel_spawns.begin(), [](const Spawn &spawn) {
+            return bitris_spawn{static_cast<uint8_t>(spawn.orientation), spawn.cx, spawn.cy};
+        });
+        bitris_isa::selected_kernels().get<Data>().search_batch(
+                boards.front().data(), kernel_spawns.data(), kernel_spawns.size(), static_cast<uint8_t>(shape),
+                out.front().data()
+        );
+    }
+
+    template std::array<uint8_t, 40> dispatch_search(const std::array<uint8_t, 10> &, Shape, const Spawn &);
+    template std::array<uint16_t, 40> dispatch_search(const std::array<uint16_t, 10> &, Shape, const Spawn &);
+    template std::array<uint32_t, 40> dispatch_search(const std::array<uint32_t, 10> &, Shape, const Spawn &);
+    template std::array<uint64_t, 40> dispatch_search(const std::array<uint64_t, 10> &, Shape, const Spawn &);
+
+    template std::array<uint8_t, 40> dispatch_search(IsaLevel, const std::array<uint8_t, 10> &, Shape, const Spawn &);
+    template std::array<uint16_t, 40> dispatch_search(IsaLevel, const std::array<uint16_t, 10> &, Shape, const Spawn &);
+    template std::array<uint32_t, 40> dispatch_search(IsaLevel, const std::array<uint32_t, 10> &, Shape, const Spawn &);
+    template std::array<uint64_t, 40> dispatch_search(IsaLevel, const std::array<uint64_t, 10> &, Shape, const Spawn &);
+
+    template void dispatch_search_batch(
+            std::span<const std::array<uint8_t, 10> >, std::span<const Spawn>, Shape, std::span<std::array<uint8_t, 40> >
+    );
+    template void dispatch_search_batch(
+            std::span<const std::array<uint16_t, 10> >, std::span<const Spawn>, Shape, std::span<std::array<uint16_t, 40> >
+    );
+    template void dispatch_search_batch(
+            std::span<const std::array<uint32_t, 10> >, std::span<const Spawn>, Shape, std::span<std::array<uint32_t, 40> >
+    );
+    template void dispatch_search_batch(
+            std::span<const std::array<uint64_t, 10> >, std::span<const Spawn>, Shape, std::span<std::array<uint64_t, 40> >
+    );
+}
+
+const bitris_isa::kernels &bitris_isa::selected_kernels() {
+    static const kernels &kernels = s::kernels_of(s::selected_isa_level());
+    return kernels;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "bitris.h"
+
+// 命令セットのレベルごとにビルドした探索カーネル (search_kernels.cpp)
+// ビルドした命令セットごとに盤面の型のアラインメントが変わるため、引数は配列のポインタで受け渡す
+namespace bitris_isa {
+    // columnsは盤面の10列、outは向き×10列。Oは向きが1つのため、outの先頭の10列のみを使う
+    template<typename Data>
+    using search_fn = void (*)(
+            const Data *columns, uint8_t shape, uint8_t orientation, uint8_t cx, uint8_t cy, Data *out
+    );
+
+    // count個の盤面を同じ形で探索する。columnsとoutは盤面ごとに10列、40列ずつ並べる
+    template<typename Data>
+    using search_batch_fn = void (*)(
+            const Data *columns, const bitris_spawn *spawns, size_t count, uint8_t shape, Data *out
+    );
+
+    template<typename Data>
+    struct data_kernels {
+        search_fn<Data> search;
+        search_batch_fn<Data> search_batch;
+    };
+
+    struct kernels {
+        data_kernels<uint8_t> u8;
+        data_kernels<uint16_t> u16;
+        data_kernels<uint32_t> u32;
+        data_kernels<uint64_t> u64;
+
+        template<typename Data>
+        [[nodiscard]] const data_kernels<Data> &get() const {
+            if constexpr (std::is_same_v<Data, uint8_t>) {
+                return u8;
+            } else if constexpr (std::is_same_v<Data, uint16_t>) {
+                return u16;
+            } else if constexpr (std::is_same_v<Data, uint32_t>) {
+                return u32;
+            } else {
+                static_assert(std::is_same_v<Data, uint64_t>);
+                return u64;
+            }
+        }
+    };
+
+    // x86-64-v2 (SSE4.2), x86-64-v3 (AVX2), x86-64-v4 (AVX-512)
+    extern const kernels kernels_v2;
+    extern const kernels kernels_v3;
+    extern const kernels kernels_v4;
+
+    // 起動時に選んだカーネル (dispatch.cpp)
+    const kernels &selected_kernels();
+}
@@ -0,0 +1,64 @@
+// 複数の盤面をまとめて探索するカーネルを、BITRIS_KERNELSで指定したレベルでビルドする
+// search_kernels.cppと同じく、レベルごとの名前空間(kernels_v2_implなど)に入れる
+#define BITRIS_ABI_CONCAT_(a, b) a##b
+#define BITRIS_ABI_CONCAT(a, b) BITRIS_ABI_CONCAT_(a, b)
+#define BITRIS_ABI BITRIS_ABI_CONCAT(BITRIS_KERNELS, _impl)
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "search.hpp"
+#include "kernels.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // ChunkSize個ずつ揃えた盤面に移して、searcher::search_batchで探索する
+    template<typename Data>
+    void search_batch_kernel(
+            const Data *columns,
+            const bitris_spawn *spawns,
+            const size_t count,
+            const uint8_t shape,
+            Data *out
+    ) {
+        constexpr size_t ChunkSize = 64;
+
+        dispatch_shape(static_cast<Shape>(shape), [&]<Shape Shape>() {
+            using searcher_t = searcher<Data, Shape>;
+            constexpr auto size = searcher_t::N * 10;
+
+            std::array<typename data<Data>::AlignedBoard, ChunkSize> boards;
+            std::array<Spawn, ChunkSize> chunk_spawns;
+            std::array<std::array<Data, size>, ChunkSize> goals;
+
+            for (size_t begin = 0; begin < count; begin += ChunkSize) {
+                const auto chunk_size = std::min(ChunkSize, count - begin);
+                for (size_t index = 0; index < chunk_size; ++index) {
+                    const auto &spawn = spawns[begin + index];
+                    std::copy_n(columns + (begin + index) * 10, 10, boards[index].columns.begin());
+                    chunk_spawns[index] = {static_cast<Orientation>(spawn.orientation), spawn.cx, spawn.cy};
+                }
+
+                searcher_t::search_batch(
+                        {boards.data(), chunk_size}, {chunk_spawns.data(), chunk_size}, {goals.data(), chunk_size}
+                );
+
+                for (size_t index = 0; index < chunk_size; ++index) {
+                    auto *dest = out + (begin + index) * 4 * 10;
+                    std::copy(goals[index].begin(), goals[index].end(), dest);
+                    std::fill(dest + size, dest + 4 * 10, 0);
+                }
+            }
+        });
+    }
+
+    template void search_batch_kernel(const uint8_t *, const bitris_spawn *, size_t, uint8_t, uint8_t *);
+    template void search_batch_kernel(const uint16_t *, const bitris_spawn *, size_t, uint8_t, uint16_t *);
+    template void search_batch_kernel(const uint32_t *, const bitris_spawn *, size_t, uint8_t, uint32_t *);
+    template void search_batch_kernel(const uint64_t *, const bitris_spawn *, size_t, uint8_t, uint64_t *);
+}
+
+BITRIS_ABI_END
@@ -0,0 +1,54 @@
+// 探索カーネルを、BITRIS_KERNELSで指定した名前(kernels_v2など)でビルドする
+// CMakeから-march=x86-64-v2などを変えて、レベルごとに1回ずつビルドする
+
+// テンプレートの実体は、命令セットごとに同じ名前で別のコードになる
+// 他のレベルの実体とリンク時に混ざらないよう、ヘッダーの宣言をレベルごとの名前空間(kernels_v2_implなど)に入れる
+#define BITRIS_ABI_CONCAT_(a, b) a##b
+#define BITRIS_ABI_CONCAT(a, b) BITRIS_ABI_CONCAT_(a, b)
+#define BITRIS_ABI BITRIS_ABI_CONCAT(BITRIS_KERNELS, _impl)
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "search.hpp"
+#include "kernels.hpp"
+
+BITRIS_ABI_BEGIN
+
+namespace s {
+    // 複数の盤面をまとめて探索するカーネルは、別の翻訳単位(search_batch_kernels.cpp)でビルドする
+    // 同じ翻訳単位に置くと、インライン化の上限を分け合ってsearchが遅くなる
+    template<typename Data>
+    void search_batch_kernel(
+            const Data *columns, const bitris_spawn *spawns, size_t count, uint8_t shape, Data *out
+    );
+}
+
+BITRIS_ABI_END
+
+namespace {
+    template<typename Data>
+    void search(
+            const Data *columns,
+            const uint8_t shape,
+            const uint8_t orientation,
+            const uint8_t cx,
+            const uint8_t cy,
+            Data *out
+    ) {
+        typename data<Data>::AlignedBoard board;
+        std::copy_n(columns, 10, board.columns.begin());
+
+        const auto spawn = s::Spawn{static_cast<Orientation>(orientation), cx, cy};
+        const auto result = s::search_shape<Data>(board, static_cast<Shape>(shape), spawn);
+        std::copy(result.begin(), result.end(), out);
+    }
+}
+
+const bitris_isa::kernels bitris_isa::BITRIS_KERNELS{
+        {search<uint8_t>, s::search_batch_kernel<uint8_t>},
+        {search<uint16_t>, s::search_batch_kernel<uint16_t>},
+        {search<uint32_t>, s::search_batch_kernel<uint32_t>},
+        {search<uint64_t>, s::search_batch_kernel<uint64_t>},
+};
@@ -2,12 +2,22 @@
 #include <string>
 #include <cstdint>
 #include <array>
+#include <vector>
 
 #include <chrono>
 
 #include "pieces.hpp"
 #include "templates.hpp"
 #include "search.hpp"
+#include "parallel.hpp"
+#include "incremental.hpp"
+#include "cache.hpp"
+#include "line_clear.hpp"
+#include "dispatch.hpp"
+#include "hold.hpp"
+#include "lookahead.hpp"
+#include "perfect_clear.hpp"
+#include "features.hpp"
 
 // from https://github.com/facebook/folly/blob/7a3f5e4e81bc83a07036e2d1d99d6a5bf5932a48/folly/lang/Hint-inl.h#L107
 // Apache License 2.0
@@ -327,6 +337,249 @@ void test3() {
     }
 }
 
+template<typename T, Shape Shape, size_t BatchSize = 64>
+void bench_batch(const typename data<T>::AlignedBoard &board) {
+    using searcher = s::searcher<T, Shape>;
+    constexpr auto shape_names = "TIOLJSZ";
+    constexpr auto count = 1000000 / BatchSize;
+
+    std::vector<typename data<T>::AlignedBoard> boards(BatchSize, board);
+    std::vector<s::Spawn> spawns(BatchSize, s::Spawn{Orientation::North, 4, 20});
+    std::vector<std::array<T, searcher::N * 10> > out(BatchSize);
+
+    const auto per_call = bench<count>([&]() {
+        for (size_t index = 0; index < BatchSize; ++index) {
+            out[index] = searcher::search(boards[index], spawns[index].orientation, spawns[index].cx,
+                                          spawns[index].cy);
+        }
+        return out.data();
+    }) / BatchSize;
+    const auto batched = bench<count>([&]() {
+        searcher::search_batch(boards, spawns, out);
+        return out.data();
+    }) / BatchSize;
+
+    std::cout << "Elapsed time (" << shape_names[static_cast<int>(Shape)] << "): "
+            << per_call << " ns (per-call), " << batched << " ns (batched)" << std::endl;
+}
+
+template<typename T, Shape Shape>
+void bench_narrowed(const typename data<T>::AlignedBoard &board) {
+    using searcher = s::searcher<T, Shape>;
+    constexpr auto shape_names = "TIOLJSZ";
+
+    const auto wide = bench(searcher::search, board, Orientation::North, 4, 20);
+    const auto narrowed = bench(searcher::search_narrowed, board, Orientation::North, 4, 20);
+
+    std::cout << "Elapsed time (" << shape_names[static_cast<int>(Shape)] << "): "
+            << wide << " ns (fixed), " << narrowed << " ns (narrowed)" << std::endl;
+}
+
+template<typename T, size_t JobsPerShape = 64>
+void bench_parallel(const typename data<T>::AlignedBoard &board) {
+    using parallel = s::parallel_searcher<T>;
+    constexpr auto count = 100000 / (JobsPerShape * 7);
+
+    std::vector<s::Job<T> > jobs;
+    for (size_t index = 0; index < JobsPerShape; ++index) {
+        for (const auto shape: {Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}) {
+            jobs.push_back({board, shape, {Orientation::North, 4, 20}});
+        }
+    }
+    std::vector<typename parallel::result_t> out(jobs.size());
+
+    const auto max_threads = std::max(1U, std::thread::hardware_concurrency());
+    for (size_t thread_count = 1; thread_count <= max_threads;
+         thread_count = thread_count < max_threads ? std::min<size_t>(thread_count * 2, max_threads) : thread_count + 1) {
+        parallel searcher{thread_count};
+        const auto t = bench<count>([&]() {
+            searcher.search(jobs, out);
+            return out.data();
+        }) / static_cast<double>(jobs.size());
+        std::cout << "Elapsed time (" << thread_count << " threads): " << t << " ns/job" << std::endl;
+    }
+}
+
+template<typename T, Shape Shape>
+void bench_incremental(const typename data<T>::AlignedBoard &board) {
+    using incremental = s::incremental_searcher<T, Shape>;
+    using searcher = s::searcher<T, Shape>;
+    constexpr auto shape_names = "TIOLJSZ";
+    constexpr auto count = 10000;
+
+    // 親で到達できるすべての位置に置いた盤面を子とする
+    const auto board_t = data<T>::load(board);
+    typename incremental::state parent{};
+    const auto goals = incremental::execute(board_t, Orientation::North, 4, 20, parent);
+
+    std::vector<typename data<T>::type> children;
+    for (size_t orientation = 0; orientation < goals.size(); ++orientation) {
+        for (uint8_t x = 0; x < 10; ++x) {
+            for (uint8_t y = 0; y < bits<T>::bit_size; ++y) {
+                if (goals[orientation][x] & (bits<T>::one << y)) {
+                    children.push_back(line_clear<T>::template put<Shape>(
+                            board_t, static_cast<Orientation>(orientation), x, y
+                    ));
+                }
+            }
+        }
+    }
+
+    const auto full = bench<count>([&]() {
+        for (const auto &child: children) {
+            DoNotOptimize(searcher::execute(child, Orientation::North, 4, 20));
+        }
+        return children.size();
+    }) / static_cast<double>(children.size());
+
+    typename incremental::state state{};
+    const auto reused = bench<count>([&]() {
+        for (const auto &child: children) {
+            DoNotOptimize(incremental::execute(parent, child, state));
+        }
+        return children.size();
+    }) / static_cast<double>(children.size());
+
+    std::cout << "Elapsed time (" << shape_names[static_cast<int>(Shape)] << "): "
+            << full << " ns (full), " << reused << " ns (incremental)" << std::endl;
+}
+
+template<typename T, Shape Shape>
+void bench_cache(const typename data<T>::AlignedBoard &board) {
+    constexpr auto shape_names = "TIOLJSZ";
+    const s::Spawn spawn{Orientation::North, 4, 20};
+
+    s::search_cache<T> cache{1024};
+    cache.search(board, Shape, spawn);
+
+    const auto searched = bench([&]() {
+        return s::search_shape<T>(board, Shape, spawn);
+    });
+    const auto cached = bench([&]() {
+        return cache.search(board, Shape, spawn);
+    });
+
+    std::cout << "Elapsed time (" << shape_names[static_cast<int>(Shape)] << "): "
+            << searched << " ns (search), " << cached << " ns (hit), "
+            << cache.hits() << " hits / " << cache.misses() << " misses" << std::endl;
+}
+
+template<typename T>
+void bench_lane_shift(const char *name, const typename data<T>::AlignedBoard &board) {
+    using data_t = data<T>;
+    const auto free_space = ~data_t::load(board);
+
+    // 1回分の横移動
+    const auto generic = bench([&](const auto &reachable) {
+        return (data_t::template shift_right<1, Backend::Generic>(reachable)
+                | data_t::template shift_left<1, Backend::Generic>(reachable)) & free_space;
+    }, free_space);
+    const auto native = bench([&](const auto &reachable) {
+        return (data_t::template shift_right<1, NativeBackend>(reachable)
+                | data_t::template shift_left<1, NativeBackend>(reachable)) & free_space;
+    }, free_space);
+
+    std::cout << "Elapsed time (" << name << "): " << generic << " ns (" << backend_name(Backend::Generic) << "), "
+            << native << " ns (" << backend_name(NativeBackend) << ")" << std::endl;
+}
+
+template<typename T>
+void bench_dispatch(const char *name, const typename data<T>::AlignedBoard &board) {
+    const s::Spawn spawn{Orientation::North, 4, 20};
+
+    const auto header = bench([&]() {
+        return s::search_shape<T>(board, Shape::T, spawn);
+    });
+    std::cout << "Elapsed time (" << name << "): " << header << " ns (header)";
+
+    for (const auto level: s::all_isa_levels) {
+        if (!s::is_supported(level)) {
+            continue;
+        }
+        const auto elapsed = bench([&]() {
+            return s::dispatch_search<T>(level, board.columns, Shape::T, spawn);
+        });
+        std::cout << ", " << elapsed << " ns (" << s::isa_level_name(level) << ")";
+    }
+    std::cout << std::endl;
+}
+
+template<typename T>
+void bench_hold(const char *name, const typename data<T>::AlignedBoard &board) {
+    const s::Spawn spawn{Orientation::North, 4, 20};
+    const std::array previews{Shape::S, Shape::Z};
+
+    // 今の形とホールドの形を、別々に探索する
+    const auto separate = bench([&]() {
+        return std::pair{
+                s::search_shape<T>(board, Shape::T, spawn),
+                s::search_shape<T>(board, Shape::I, spawn),
+        };
+    });
+    const auto shared = bench([&]() {
+        return s::search_with_hold<T>(board, Shape::T, Shape::I, previews, spawn);
+    });
+
+    std::cout << "Elapsed time (" << name << "): " << separate << " ns (separate), "
+            << shared << " ns (shared)" << std::endl;
+}
+
+template<typename T>
+void bench_lookahead(const char *name, const typename data<T>::AlignedBoard &board) {
+    const std::array queue{Shape::T, Shape::I, Shape::S, Shape::Z};
+
+    // 消した行の数と、ブロックの高さで比べる
+    const auto evaluate = [](const s::Leaf<T> &leaf) {
+        int height = 0;
+        for (const auto column: leaf.board.columns) {
+            height = std::max(height, static_cast<int>(std::bit_width(column)));
+        }
+        return static_cast<int>(leaf.cleared_lines) * 100 - height;
+    };
+    s::lookahead_searcher<T, decltype(evaluate)> searcher{evaluate};
+
+    for (const size_t depth: {1, 2, 3}) {
+        const auto elapsed = bench<10>([&]() {
+            return searcher.search(board, queue, std::nullopt, depth);
+        });
+        const auto &stats = searcher.last_stats();
+        std::cout << "Elapsed time (" << name << ", depth " << depth << "): " << elapsed / 1000 << " us, "
+                << stats.nodes << " nodes, " << stats.duplicates << " duplicates" << std::endl;
+    }
+}
+
+template<typename T>
+void bench_features(const char *name, const typename data<T>::AlignedBoard &board) {
+    const auto single = bench([&]() {
+        return features<T>::extract(board);
+    });
+
+    constexpr size_t count = 64;
+    const std::vector boards(count, board);
+    std::vector<board_features> out(count);
+    const auto batched = bench<10000>([&]() {
+        features<T>::extract_batch(boards, out);
+        return out.data();
+    }) / count;
+
+    std::cout << "Elapsed time (" << name << "): " << single << " ns (single), "
+            << batched << " ns (batch)" << std::endl;
+}
+
+template<typename T>
+void bench_spins(const char *name, const typename data<T>::AlignedBoard &board) {
+    using searcher_t = s::searcher<T, Shape::T>;
+    const auto goals = bench([&]() {
+        return searcher_t::search(board, Orientation::North, 4, 20);
+    });
+    const auto spins = bench([&]() {
+        return searcher_t::search_spins(board, Orientation::North, 4, 20);
+    });
+
+    std::cout << "Elapsed time (" << name << "): " << goals << " ns (goals), "
+            << spins << " ns (with spins)" << std::endl;
+}
+
 int main() {
     test1();
     test2();
@@ -368,6 +621,221 @@ int main() {
             std::cout << "Elapsed time (" << shape_names[static_cast<int>(Shape)] << "): " << t << " ns" << std::endl;
         });
     }
+    // lzt (128-bit)
+    {
+        std::cout << "# LZT (128-bit)" << std::endl;
+        using T = uint128_t;
+        const auto board_bytes = lzt<T>();
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            const auto t = bench(s::searcher<T, Shape>::search, board_bytes, Orientation::North, 4, 20);
+            std::cout << "Elapsed time (" << shape_names[static_cast<int>(Shape)] << "): " << t << " ns" << std::endl;
+        });
+    }
+
+    std::cout << std::endl;
+
+    // all shapes at once
+    {
+        std::cout << "# ALL SHAPES" << std::endl;
+        {
+            using T = uint8_t;
+            const auto board_bytes = data<T>::AlignedBoard{};
+            const auto t = bench(s::search_all_shapes<T>, board_bytes, Orientation::North, 4, 20);
+            std::cout << "Elapsed time (EMPTY): " << t << " ns" << std::endl;
+        }
+        {
+            using T = uint16_t;
+            const auto board_bytes = lemontea_tspin_board<T>();
+            const auto t = bench(s::search_all_shapes<T>, board_bytes, Orientation::North, 4, 20);
+            std::cout << "Elapsed time (LEMONTEA): " << t << " ns" << std::endl;
+        }
+        {
+            using T = uint32_t;
+            const auto board_bytes = lzt<T>();
+            const auto t = bench(s::search_all_shapes<T>, board_bytes, Orientation::North, 4, 20);
+            std::cout << "Elapsed time (LZT): " << t << " ns" << std::endl;
+        }
+    }
+
+    std::cout << std::endl;
+
+    // per-call vs batched
+    {
+        std::cout << "# EMPTY (batch)" << std::endl;
+        using T = uint8_t;
+        const auto board_bytes = data<T>::AlignedBoard{};
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            bench_batch<T, Shape>(board_bytes);
+        });
+    }
+    {
+        std::cout << "# LEMONTEA (batch)" << std::endl;
+        using T = uint16_t;
+        const auto board_bytes = lemontea_tspin_board<T>();
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            bench_batch<T, Shape>(board_bytes);
+        });
+    }
+    {
+        std::cout << "# LZT (batch)" << std::endl;
+        using T = uint32_t;
+        const auto board_bytes = lzt<T>();
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            bench_batch<T, Shape>(board_bytes);
+        });
+    }
+
+
+    std::cout << std::endl;
+
+    // uint64_t固定 vs 高さに合わせて選んだ幅
+    static_for_t<{0, 1, 2}>([&]<int Index>() {
+        using T = uint64_t;
+        constexpr auto names = std::array{"EMPTY", "LEMONTEA", "LZT"};
+        std::cout << "# " << names[Index] << " (narrowed)" << std::endl;
+
+        const auto board_bytes = [] {
+            if constexpr (Index == 0) {
+                return data<T>::AlignedBoard{};
+            } else if constexpr (Index == 1) {
+                return lemontea_tspin_board<T>();
+            } else {
+                return lzt<T>();
+            }
+        }();
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            bench_narrowed<T, Shape>(board_bytes);
+        });
+    });
+
+
+    std::cout << std::endl;
+
+    // スレッド数ごとのスケーリング
+    {
+        std::cout << "# LZT (parallel)" << std::endl;
+        using T = uint32_t;
+        bench_parallel<T>(lzt<T>());
+    }
+
+
+    std::cout << std::endl;
+
+    // 1つ置いた子の盤面の探索
+    {
+        std::cout << "# LZT (incremental)" << std::endl;
+        using T = uint32_t;
+        const auto board_bytes = lzt<T>();
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            bench_incremental<T, Shape>(board_bytes);
+        });
+    }
+
+
+    std::cout << std::endl;
+
+    // キャッシュにヒットした場合
+    {
+        std::cout << "# LZT (cache)" << std::endl;
+        using T = uint32_t;
+        const auto board_bytes = lzt<T>();
+
+        static_for_t<{Shape::I, Shape::J, Shape::L, Shape::O, Shape::S, Shape::T, Shape::Z}>([&]<Shape Shape>() {
+            bench_cache<T, Shape>(board_bytes);
+        });
+    }
+
+
+    std::cout << std::endl;
+
+    // 横移動の命令セットごとの比較。探索全体は、ビルドした命令セットのものになる
+    {
+        std::cout << "# LANE SHIFT" << std::endl;
+        bench_lane_shift<uint16_t>("u16", lemontea_tspin_board<uint16_t>());
+        bench_lane_shift<uint32_t>("u32", lzt<uint32_t>());
+        bench_lane_shift<uint64_t>("u64", lzt<uint64_t>());
+    }
+
+    std::cout << std::endl;
+
+    // ライブラリの命令セットごとのカーネル。ヘッダーの探索は、ビルドした命令セットのものになる
+    {
+        std::cout << "# DISPATCH (" << s::isa_level_name(s::selected_isa_level()) << ")" << std::endl;
+        bench_dispatch<uint16_t>("u16", lemontea_tspin_board<uint16_t>());
+        bench_dispatch<uint32_t>("u32", lzt<uint32_t>());
+        bench_dispatch<uint64_t>("u64", lzt<uint64_t>());
+    }
+
+    std::cout << std::endl;
+
+    // 今の形(T)とホールド(I)の置ける位置を、盤面の読み込みを共有して探索する
+    {
+        std::cout << "# HOLD" << std::endl;
+        bench_hold<uint16_t>("u16", lemontea_tspin_board<uint16_t>());
+        bench_hold<uint32_t>("u32", lzt<uint32_t>());
+        bench_hold<uint64_t>("u64", lzt<uint64_t>());
+    }
+
+    std::cout << std::endl;
+
+    // ホールドを使って、ネクストを読む
+    {
+        std::cout << "# LOOKAHEAD" << std::endl;
+        bench_lookahead<uint16_t>("u16", lemontea_tspin_board<uint16_t>());
+        bench_lookahead<uint32_t>("u32", lzt<uint32_t>());
+    }
+
+    std::cout << std::endl;
+
+    // 評価に使う特徴量を、列ごとのビット演算で求める
+    {
+        std::cout << "# FEATURES" << std::endl;
+        bench_features<uint16_t>("u16", lemontea_tspin_board<uint16_t>());
+        bench_features<uint32_t>("u32", lzt<uint32_t>());
+        bench_features<uint64_t>("u64", lzt<uint64_t>());
+    }
+
+    std::cout << std::endl;
+
+    // Tのgoalに加えて、T-spinとall-spinの判定を求める
+    {
+        std::cout << "# SPINS" << std::endl;
+        bench_spins<uint16_t>("u16", lemontea_tspin_board<uint16_t>());
+        bench_spins<uint32_t>("u32", lzt<uint32_t>());
+        bench_spins<uint64_t>("u64", lzt<uint64_t>());
+    }
+
+    std::cout << std::endl;
+
+    // 空の盤面から4段のパーフェクトクリア
+    {
+        std::cout << "# PERFECT CLEAR" << std::endl;
+        const data<uint8_t>::AlignedBoard board{};
+        const std::array queue{
+                Shape::I, Shape::L, Shape::J, Shape::O, Shape::S, Shape::Z, Shape::T,
+                Shape::L, Shape::J, Shape::O, Shape::I,
+        };
+
+        for (const size_t thread_count: {size_t{1}, size_t{std::thread::hardware_concurrency()}}) {
+            const s::perfect_clear_finder finder{thread_count};
+            const auto exists = bench<100>([&]() {
+                return finder.exists(board, queue, std::nullopt, 4);
+            });
+            size_t solutions = 0;
+            const auto all = bench<1>([&]() {
+                solutions = finder.find_all(board, queue, std::nullopt, 4).size();
+                return solutions;
+            });
+            std::cout << "Elapsed time (" << thread_count << " threads): " << exists / 1000 << " us (exists), "
+                    << all / 1000000 << " ms (" << solutions << " solutions)" << std::endl;
+        }
+    }
 
     return 0;
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "data.hpp"
+
+namespace core {
+    // 複数のテストで使う盤面。T-Spin Tripleの位置がある
+    constexpr auto lemontea = ""
+                              "X........."
+                              "X........."
+                              "XX......XX"
+                              "XXX....XXX"
+                              "XXXX...XXX"
+                              "XXXX..XXXX"
+                              "XXX...XXXX"
+                              "XXXX.XXXXX";
+
+    // テストで書いた盤面を、searcherに渡す揃えた盤面にする
+    template<typename Data>
+    typename data<Data>::AlignedBoard to_aligned(const std::string &str) {
+        typename data<Data>::AlignedBoard board{};
+        data<Data>::from_str(str).value().copy_to(board.columns.data(), stdx::vector_aligned);
+        return board;
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <deque>
+
+#include "pieces.hpp"
+#include "cells.hpp"
+#include "kicks.hpp"
+#include "rotate.hpp"
+#include "bits.hpp"
+#include "free_spaces.hpp"
+
+namespace core {
+    // s::searcherと比べるための、(向き, x, y)の状態を1つずつたどる幅優先探索
+    // ビット演算をまとめずに、ミノのブロックを1つずつ盤面と照らし合わせる
+    //
+    // searcherと同じく、次の決まりに従う
+    // - 盤面の上端より上は空いている。左右の壁と床は埋まっている
+    // - spawnの行で置ける位置が1つの区間にまとまっている(またはspawnが盤面より上の)場合は、
+    //   spawnの行から下で、最も高い屋根より上の置ける位置すべてから始める。そうでなければspawnの位置から始める
+    // - 回転は上から2段を除く位置からのみ行う
+    template<typename Data, Shape Shape, typename Kicks = srs_kicks>
+    struct reference_searcher {
+        static constexpr size_t N = free_spaces<Data, Shape>::N;
+        static constexpr int Height = bits<Data>::bit_size;
+
+        struct state {
+            size_t index;
+            int x;
+            int y;
+        };
+
+        static std::array<Data, N * 10> search(
+                const std::array<Data, 10> &board,
+                const Orientation spawn_orientation,
+                const uint8_t spawn_cx,
+                const uint8_t spawn_cy
+        ) {
+            const auto spawn_index = N == 1 ? 0 : static_cast<size_t>(spawn_orientation);
+
+            std::vector<bool> visited(N * 10 * Height, false);
+            std::deque<state> queue;
+            const auto visit = [&](const size_t index, const int x, const int y) {
+                if (!fits(board, index, x, y)) {
+                    return;
+                }
+                const auto key = (index * 10 + x) * Height + y;
+                if (!visited[key]) {
+                    visited[key] = true;
+                    queue.push_back({index, x, y});
+                }
+            };
+
+            if (is_continuous_line(board, spawn_index, spawn_cy)) {
+                const auto top = std::min<int>(spawn_cy, Height - 1);
+                for (int y = highest_roof(board, spawn_index, top) + 1; y <= top; ++y) {
+                    for (int x = 0; x < 10; ++x) {
+                        visit(spawn_index, x, y);
+                    }
+                }
+            } else {
+                visit(spawn_index, spawn_cx, spawn_cy);
+            }
+
+            const auto rotations = rotation_table();
+            while (!queue.empty()) {
+                const auto current = queue.front();
+                queue.pop_front();
+
+                visit(current.index, current.x - 1, current.y);
+                visit(current.index, current.x + 1, current.y);
+                visit(current.index, current.x, current.y - 1);
+
+                if (N == 1 || Height - 2 <= current.y) {
+                    continue;
+                }
+                for (const auto &rotation: rotations[current.index]) {
+                    for (const auto &offset: rotation.offsets) {
+                        const auto x = current.x + offset.x;
+                        const auto y = current.y + offset.y;
+                        if (fits(board, rotation.to, x, y)) {
+                            visit(rotation.to, x, y);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // 1段下に動けない位置で止まる
+            std::array<Data, N * 10> goals{};
+            for (size_t index = 0; index < N; ++index) {
+                for (int x = 0; x < 10; ++x) {
+                    for (int y = 0; y < Height; ++y) {
+                        if (visited[(index * 10 + x) * Height + y] && !fits(board, index, x, y - 1)) {
+                            goals[index * 10 + x] |= static_cast<Data>(bits<Data>::one << y);
+                        }
+                    }
+                }
+            }
+            return goals;
+        }
+
+    private:
+        static constexpr auto AllCells = cells<Shape>::get_all();
+
+        struct rotation_entry {
+            size_t to;
+            std::vector<Offset> offsets;
+        };
+
+        // 回転の中心を(x, y)に置いたとき、すべてのブロックが空いているか
+        static bool fits(const std::array<Data, 10> &board, const size_t index, const int x, const int y) {
+            if (x < 0 || 10 <= x || y < 0 || Height <= y) {
+                return false;
+            }
+            for (const auto &cell: AllCells[index]) {
+                const auto cx = x + cell.x;
+                const auto cy = y + cell.y;
+                if (cx < 0 || 10 <= cx || cy < 0) {
+                    return false;
+                }
+                if (cy < Height && (board[cx] & (bits<Data>::one << cy))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool is_continuous_line(const std::array<Data, 10> &board, const size_t index, const int y) {
+            if (Height <= y) {
+                return true;
+            }
+            size_t runs = 0;
+            for (int x = 0; x < 10; ++x) {
+                if (fits(board, index, x, y) && !fits(board, index, x - 1, y)) {
+                    ++runs;
+                }
+            }
+            return runs <= 1;
+        }
+
+        // top以下で、置ける位置の真上が置けない行のうち、最も高い行。なければ-1
+        static int highest_roof(const std::array<Data, 10> &board, const size_t index, const int top) {
+            for (int y = top - 1; 0 <= y; --y) {
+                for (int x = 0; x < 10; ++x) {
+                    if (fits(board, index, x, y) && !fits(board, index, x, y + 1)) {
+                        return y;
+                    }
+                }
+            }
+            return -1;
+        }
+
+        static std::array<std::vector<rotation_entry>, 4> rotation_table() {
+            std::array<std::vector<rotation_entry>, 4> table;
+            static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                    [&]<Orientation From>() {
+                        const auto add = [&]<Rotation Rotation>() {
+                            constexpr auto offsets = Kicks::template get<{Shape, From}, Rotation>();
+                            table[static_cast<size_t>(From)].push_back({
+                                    static_cast<size_t>(rotate_to(From, Rotation)),
+                                    {offsets.begin(), offsets.end()},
+                            });
+                        };
+                        add.template operator()<Rotation::Cw>();
+                        add.template operator()<Rotation::Ccw>();
+                        if constexpr (Kicks::has_flip) {
+                            add.template operator()<Rotation::Flip>();
+                        }
+                    });
+            return table;
+        }
+    };
+}
@@ -38,6 +38,15 @@ namespace core {
         }
     }
 
+    TEST_F(BitsTest, most_significant_index_uint128_t) {
+        using T = uint128_t;
+        EXPECT_EQ(bits<T>::most_significant_index(0), -1);
+        for (int index = 0; index < 128; ++index) {
+            EXPECT_EQ(bits<T>::most_significant_index(bits<T>::one << index), index);
+        }
+        EXPECT_EQ(bits<T>::most_significant_index(bits<T>::full), 127);
+    }
+
     TEST_F(BitsTest, used_rows) {
         using T = uint8_t;
         // empty
@@ -55,11 +64,25 @@ namespace core {
         }
     }
 
+    TEST_F(BitsTest, extract) {
+        EXPECT_EQ(bits<uint8_t>::extract(0b10110110, 0b11110000), 0b1011);
+        EXPECT_EQ(bits<uint8_t>::extract(0b10110110, 0b01010101), 0b0110);
+        EXPECT_EQ(bits<uint16_t>::extract(0xffff, 0), 0);
+        EXPECT_EQ(bits<uint32_t>::extract(0x80000001, 0x80000001), 0b11);
+        EXPECT_EQ(bits<uint64_t>::extract(0xf0f0f0f0f0f0f0f0, 0xff00000000000000), 0xf0);
+
+        using T = uint128_t;
+        const T v = (T{0b101} << 100) | 0b11;
+        const T mask = (T{0b111} << 100) | 0b1111;
+        EXPECT_TRUE(bits<T>::extract(v, mask) == 0b1010011);
+    }
+
     TEST_F(BitsTest, full) {
         EXPECT_EQ(bits<uint8_t>::full, 0xff);
         EXPECT_EQ(bits<uint16_t>::full, 0xffff);
         EXPECT_EQ(bits<uint32_t>::full, 0xffffffff);
         EXPECT_EQ(bits<uint64_t>::full, 0xffffffffffffffff);
+        EXPECT_TRUE(bits<uint128_t>::full == ~uint128_t{0});
     }
 
     TEST_F(BitsTest, bit_size) {
@@ -67,5 +90,6 @@ namespace core {
         EXPECT_EQ(bits<uint16_t>::bit_size, 16);
         EXPECT_EQ(bits<uint32_t>::bit_size, 32);
         EXPECT_EQ(bits<uint64_t>::bit_size, 64);
+        EXPECT_EQ(bits<uint128_t>::bit_size, 128);
     }
 }
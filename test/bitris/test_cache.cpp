@@ -0,0 +1,103 @@
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "cache.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class CacheTest : public ::testing::Test {
+    };
+
+    template<typename Data>
+    typename data<Data>::AlignedBoard make_board(const size_t seed) {
+        auto board = to_aligned<Data>(
+                ""
+                "XX......XX"
+                "XXX....XXX"
+                "XXXX...XXX"
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        );
+        board.columns[seed % 10] |= bits<Data>::one << (6 + seed % 3);
+        return board;
+    }
+
+    TEST_F(CacheTest, hit_and_miss) {
+        using Data = uint16_t;
+        s::search_cache<Data> cache{1024};
+        const auto board = make_board<Data>(0);
+        const s::Spawn spawn{Orientation::North, 4, 12};
+
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            const auto expected = s::search_shape<Data>(board, Shape, spawn);
+            EXPECT_EQ(cache.search(board, Shape, spawn), expected);
+            EXPECT_EQ(cache.search(board, Shape, spawn), expected);
+        });
+        EXPECT_EQ(cache.misses(), 7);
+        EXPECT_EQ(cache.hits(), 7);
+
+        // spawnが異なれば別のキーになる
+        cache.search(board, Shape::T, {Orientation::East, 4, 12});
+        cache.search(board, Shape::T, {Orientation::North, 5, 12});
+        EXPECT_EQ(cache.misses(), 9);
+
+        cache.clear();
+        EXPECT_EQ(cache.hits(), 0);
+        EXPECT_EQ(cache.misses(), 0);
+
+        typename s::search_cache<Data>::result_t out{};
+        EXPECT_FALSE(cache.find(board, Shape::T, spawn, out));
+    }
+
+    TEST_F(CacheTest, small_capacity_keeps_results_correct) {
+        using Data = uint32_t;
+        s::search_cache<Data> cache{4};
+        EXPECT_EQ(cache.capacity(), 4);
+
+        // エントリより多くのキーを入れても、返す結果は探索と同じ
+        const s::Spawn spawn{Orientation::North, 4, 20};
+        for (int repeat = 0; repeat < 2; ++repeat) {
+            for (size_t seed = 0; seed < 30; ++seed) {
+                const auto board = make_board<Data>(seed);
+                const auto shape = static_cast<Shape>(seed % 7);
+                EXPECT_EQ(cache.search(board, shape, spawn), s::search_shape<Data>(board, shape, spawn));
+            }
+        }
+        EXPECT_EQ(cache.hits() + cache.misses(), 60);
+    }
+
+    TEST_F(CacheTest, shared_across_threads) {
+        using Data = uint16_t;
+        s::search_cache<Data> cache{64};
+        const s::Spawn spawn{Orientation::North, 4, 12};
+
+        std::vector<typename data<Data>::AlignedBoard> boards;
+        std::vector<typename s::search_cache<Data>::result_t> expected;
+        for (size_t seed = 0; seed < 30; ++seed) {
+            boards.push_back(make_board<Data>(seed));
+            expected.push_back(s::search_shape<Data>(boards.back(), static_cast<Shape>(seed % 7), spawn));
+        }
+
+        std::atomic<size_t> errors{0};
+        std::vector<std::thread> threads;
+        for (size_t thread = 0; thread < 4; ++thread) {
+            threads.emplace_back([&, thread] {
+                for (size_t repeat = 0; repeat < 200; ++repeat) {
+                    const auto index = (repeat * 7 + thread) % boards.size();
+                    const auto actual = cache.search(boards[index], static_cast<Shape>(index % 7), spawn);
+                    if (actual != expected[index]) {
+                        errors.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(errors.load(), 0);
+        EXPECT_EQ(cache.hits() + cache.misses(), 800);
+        EXPECT_LT(0, cache.hits());
+    }
+}
@@ -0,0 +1,81 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "bitris.h"
+#include "dispatch.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class CApiTest : public ::testing::Test {
+    };
+
+    TEST_F(CApiTest, search_u32) {
+        using Data = uint32_t;
+        const auto board = to_aligned<Data>(lemontea);
+
+        for (const auto shape: {Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}) {
+            const auto expected = s::search_shape<Data>(board, shape, {Orientation::North, 4, 20});
+
+            std::array<Data, 4 * 10> actual{};
+            EXPECT_EQ(bitris_search_u32(
+                    board.columns.data(), static_cast<uint8_t>(shape), BITRIS_ORIENTATION_NORTH, 4, 20, actual.data()
+            ), BITRIS_OK);
+            EXPECT_EQ(actual, expected);
+        }
+    }
+
+    TEST_F(CApiTest, search_batch_u16) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(lemontea);
+        const auto empty = to_aligned<Data>("");
+
+        // ChunkSizeを超える数の盤面で、向きとspawnを混ぜる
+        constexpr size_t count = 70;
+        std::vector<Data> boards;
+        std::vector<bitris_spawn> spawns;
+        for (size_t index = 0; index < count; ++index) {
+            const auto &columns = (index % 3 == 0 ? empty : board).columns;
+            boards.insert(boards.end(), columns.begin(), columns.end());
+            spawns.push_back({static_cast<uint8_t>(index % 4), static_cast<uint8_t>(3 + index % 3), 10});
+        }
+
+        for (const auto shape: {Shape::T, Shape::O, Shape::S}) {
+            std::vector<Data> out(count * 4 * 10, 0xffff);
+            EXPECT_EQ(bitris_search_batch_u16(
+                    boards.data(), spawns.data(), count, static_cast<uint8_t>(shape), out.data()
+            ), BITRIS_OK);
+
+            for (size_t index = 0; index < count; ++index) {
+                const auto &spawn = spawns[index];
+                const auto expected = s::search_shape<Data>(
+                        index % 3 == 0 ? empty : board, shape,
+                        {static_cast<Orientation>(spawn.orientation), spawn.cx, spawn.cy}
+                );
+                const auto begin = out.begin() + static_cast<std::ptrdiff_t>(index * 4 * 10);
+                EXPECT_TRUE(std::equal(expected.begin(), expected.end(), begin)) << "index=" << index;
+            }
+        }
+    }
+
+    TEST_F(CApiTest, invalid_argument) {
+        using Data = uint8_t;
+        std::array<Data, 10> board{};
+        std::array<Data, 4 * 10> out{};
+
+        EXPECT_EQ(bitris_search_u8(board.data(), 7, 0, 4, 6, out.data()), BITRIS_ERROR_INVALID_ARGUMENT);
+        EXPECT_EQ(bitris_search_u8(board.data(), 0, 4, 4, 6, out.data()), BITRIS_ERROR_INVALID_ARGUMENT);
+        EXPECT_EQ(bitris_search_u8(board.data(), 0, 0, 10, 6, out.data()), BITRIS_ERROR_INVALID_ARGUMENT);
+        EXPECT_EQ(bitris_search_u8(nullptr, 0, 0, 4, 6, out.data()), BITRIS_ERROR_INVALID_ARGUMENT);
+
+        const std::array<bitris_spawn, 2> spawns{{{0, 4, 6}, {0, 12, 6}}};
+        std::array<Data, 2 * 10> boards{};
+        std::array<Data, 2 * 4 * 10> batch_out{};
+        EXPECT_EQ(bitris_search_batch_u8(boards.data(), spawns.data(), 2, 0, batch_out.data()),
+                  BITRIS_ERROR_INVALID_ARGUMENT);
+        EXPECT_EQ(bitris_search_batch_u8(nullptr, nullptr, 0, 0, nullptr), BITRIS_OK);
+    }
+
+    TEST_F(CApiTest, isa_level) {
+        EXPECT_STREQ(bitris_isa_level(), s::isa_level_name(s::selected_isa_level()));
+    }
+}
@@ -0,0 +1,99 @@
+#include <sstream>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "corpus.hpp"
+
+namespace core {
+    class CorpusTest : public ::testing::Test {
+    };
+
+    constexpr std::array<uint8_t, 4> heights{4, 8, 16, 40};
+
+    TEST_F(CorpusTest, deterministic) {
+        auto generator1 = s::corpus_generator{42};
+        auto generator2 = s::corpus_generator{42};
+        auto generator3 = s::corpus_generator{43};
+        const auto boards1 = generator1.generate(4, heights);
+        const auto boards2 = generator2.generate(4, heights);
+        const auto boards3 = generator3.generate(4, heights);
+
+        EXPECT_EQ(boards1.size(), s::all_board_kinds.size() * heights.size() * 4);
+        EXPECT_EQ(boards1, boards2);
+        EXPECT_NE(boards1, boards3);
+    }
+
+    TEST_F(CorpusTest, within_height) {
+        auto generator = s::corpus_generator{1};
+        for (const auto &board: generator.generate(16, heights)) {
+            uint64_t filled = ~uint64_t{0};
+            for (const auto column: board.columns) {
+                EXPECT_LE(std::bit_width(column), board.height);
+                filled &= column;
+            }
+            // 揃った行は残らない
+            EXPECT_EQ(filled, 0);
+
+            // チーズは指定した高さまで埋まる
+            if (board.kind == s::BoardKind::Cheese) {
+                uint64_t occupied = 0;
+                for (const auto column: board.columns) {
+                    occupied |= column;
+                }
+                EXPECT_EQ(std::bit_width(occupied), board.height);
+            }
+        }
+    }
+
+    TEST_F(CorpusTest, to_aligned) {
+        s::CorpusBoard board{s::BoardKind::Stack, 12, {}};
+        board.columns[3] = 0b1011;
+        board.columns[9] = uint64_t{1} << 11;
+
+        EXPECT_FALSE(board.to_aligned<uint8_t>().has_value());
+        const auto aligned = board.to_aligned<uint16_t>();
+        ASSERT_TRUE(aligned.has_value());
+        EXPECT_EQ(aligned->columns[3], 0b1011);
+        EXPECT_EQ(aligned->columns[9], 1 << 11);
+    }
+
+    TEST_F(CorpusTest, write_and_read) {
+        auto generator = s::corpus_generator{7};
+        const auto boards = generator.generate(3, heights);
+
+        std::stringstream stream;
+        s::write_corpus(stream, boards);
+        const auto bytes = stream.str();
+
+        const auto loaded = s::read_corpus(stream);
+        ASSERT_TRUE(loaded.has_value());
+        EXPECT_EQ(*loaded, boards);
+
+        // 壊れたデータは読まない
+        std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+        EXPECT_FALSE(s::read_corpus(truncated).has_value());
+
+        std::stringstream wrong_magic("XTRC" + bytes.substr(4));
+        EXPECT_FALSE(s::read_corpus(wrong_magic).has_value());
+    }
+
+    // 作った盤面で、探索の別の実装と結果を比べる
+    template<typename Data, Shape Shape>
+    void expect_narrowed_equal_to_search(const std::vector<s::CorpusBoard> &boards) {
+        using searcher = s::searcher<Data, Shape>;
+        for (const auto &corpus_board: boards) {
+            const auto board = corpus_board.to_aligned<Data>().value();
+            const auto expected = searcher::search(board, Orientation::North, 4, 20);
+            const auto actual = searcher::search_narrowed(board, Orientation::North, 4, 20);
+            EXPECT_EQ(actual, expected) << s::board_kind_name(corpus_board.kind);
+        }
+    }
+
+    TEST_F(CorpusTest, search_narrowed_u64) {
+        auto generator = s::corpus_generator{3};
+        const auto boards = generator.generate(4, heights);
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_narrowed_equal_to_search<uint64_t, Shape>(boards);
+        });
+    }
+}
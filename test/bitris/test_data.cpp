@@ -194,4 +194,84 @@
          ASSERT_EQ( data_t::is_continuous_line(free_space, 4), true);
          ASSERT_EQ( data_t::is_continuous_line(free_space, 5), true);
      }
+
+     TEST_F(DataTest, fill_down_u32) {
+         using Data = uint32_t;
+         using data_t = data<Data>;
+         const auto free_space = ~data_t::from_str(
+             ""
+             "X........."
+             "....X....."
+             ".X........"
+             ".........."
+             ".........."
+             ".........."
+             ".........."
+             "..X......X"
+             "...X......"
+             "XXXX.XXXX."
+         ).value();
+
+         // 10段目から、ブロックにぶつかるまで落とす
+         const auto seed = data_t::make_square(bits<Data>::one << 9) & free_space;
+         const auto expected = data_t::from_str(
+             ""
+             ".XXXXXXXXX"
+             ".XXX.XXXXX"
+             "..XX.XXXXX"
+             "..XX.XXXXX"
+             "..XX.XXXXX"
+             "..XX.XXXXX"
+             "..XX.XXXXX"
+             "...X.XXXX."
+             ".....XXXX."
+             ".........."
+         ).value();
+         ASSERT_EQ(all_of(data_t::fill_down(seed, free_space) == expected), true);
+
+         // 1回だけずらすと、1段しか落ちない
+         const auto expected1 = data_t::from_str(
+             ""
+             ".XXXXXXXXX"
+             ".XXX.XXXXX"
+             ".........."
+             ".........."
+             ".........."
+             ".........."
+             ".........."
+             ".........."
+             ".........."
+             ".........."
+         ).value();
+         ASSERT_EQ(all_of(data_t::template fill_down<1>(seed, free_space) == expected1), true);
+     }
+
+
+     template<typename Data>
+     void expect_lane_shift_same_as_generic() {
+         using data_t = data<Data>;
+         auto board = typename data_t::AlignedBoard{};
+         for (size_t x = 0; x < 10; ++x) {
+             board.columns[x] = static_cast<Data>(0x9e3779b97f4a7c15ULL * (x + 1));
+         }
+         const auto v = data_t::load(board);
+
+         static_for_t<{1, 2, 3, 4, 5, 7, 9}>([&]<size_t Amount>() {
+             const auto right = data_t::template shift_right<Amount>(v);
+             const auto left = data_t::template shift_left<Amount>(v);
+             for (size_t x = 0; x < 10; ++x) {
+                 EXPECT_EQ(right[x], Amount <= x ? board.columns[x - Amount] : 0) << "right=" << Amount;
+                 EXPECT_EQ(left[x], x + Amount < 10 ? board.columns[x + Amount] : 0) << "left=" << Amount;
+             }
+             EXPECT_TRUE(data_t::is_equal_to(right, data_t::template shift_right<Amount, Backend::Generic>(v)));
+             EXPECT_TRUE(data_t::is_equal_to(left, data_t::template shift_left<Amount, Backend::Generic>(v)));
+         });
+     }
+
+     TEST_F(DataTest, lane_shift) {
+         expect_lane_shift_same_as_generic<uint8_t>();
+         expect_lane_shift_same_as_generic<uint16_t>();
+         expect_lane_shift_same_as_generic<uint32_t>();
+         expect_lane_shift_same_as_generic<uint64_t>();
+     }
  }
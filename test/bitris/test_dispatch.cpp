@@ -0,0 +1,69 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dispatch.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class DispatchTest : public ::testing::Test {
+    };
+
+    template<typename Data>
+    void expect_dispatch_equal_to_search(const std::string &str, const uint8_t spawn_cy) {
+        const auto board = to_aligned<Data>(str);
+
+        for (const auto shape: {Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}) {
+            for (const auto orientation: {Orientation::North, Orientation::East}) {
+                const s::Spawn spawn{orientation, 4, spawn_cy};
+                const auto expected = s::search_shape<Data>(board, shape, spawn);
+                EXPECT_EQ(s::dispatch_search<Data>(board.columns, shape, spawn), expected);
+
+                for (const auto level: s::all_isa_levels) {
+                    if (s::is_supported(level)) {
+                        EXPECT_EQ(s::dispatch_search<Data>(level, board.columns, shape, spawn), expected)
+                                << s::isa_level_name(level);
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_F(DispatchTest, selected_level) {
+        // v2は常に使え、選ばれたレベルも使える
+        EXPECT_TRUE(s::is_supported(s::IsaLevel::X86_64_V2));
+        EXPECT_TRUE(s::is_supported(s::selected_isa_level()));
+    }
+
+    TEST_F(DispatchTest, dispatch_search) {
+        expect_dispatch_equal_to_search<uint8_t>(lemontea, 6);
+        expect_dispatch_equal_to_search<uint16_t>(lemontea, 10);
+        expect_dispatch_equal_to_search<uint32_t>(lemontea, 20);
+        expect_dispatch_equal_to_search<uint64_t>(lemontea, 20);
+    }
+
+    TEST_F(DispatchTest, dispatch_search_batch) {
+        using Data = uint32_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XX........"
+                "X........."
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        );
+
+        // カーネルの中で分ける単位(64個)をまたぐ数にする
+        constexpr size_t count = 130;
+        std::vector<std::array<Data, 10> > boards(count, board.columns);
+        std::vector<s::Spawn> spawns;
+        for (size_t index = 0; index < count; ++index) {
+            spawns.push_back({static_cast<Orientation>(index % 4), 4, 20});
+        }
+
+        std::vector<std::array<Data, 4 * 10> > out(boards.size());
+        s::dispatch_search_batch<Data>(boards, spawns, Shape::T, out);
+        for (size_t index = 0; index < boards.size(); ++index) {
+            EXPECT_EQ(out[index], s::search_shape<Data>(board, Shape::T, spawns[index])) << "index=" << index;
+        }
+    }
+}
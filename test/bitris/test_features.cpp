@@ -0,0 +1,131 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "features.hpp"
+#include "corpus.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class FeaturesTest : public ::testing::Test {
+    };
+
+    // 1マスずつ数える
+    template<typename Data>
+    board_features scalar_features(const std::array<Data, 10> &columns) {
+        constexpr int height = bits<Data>::bit_size;
+        const auto filled = [&](const int x, const int y) {
+            return x < 0 || 10 <= x || ((columns[x] >> y) & 1) != 0;
+        };
+
+        board_features result{};
+        for (int x = 0; x < 10; ++x) {
+            int top = 0;
+            for (int y = 0; y < height; ++y) {
+                if (filled(x, y)) {
+                    top = y + 1;
+                }
+            }
+            result.heights[x] = static_cast<uint8_t>(top);
+            result.max_height = std::max<uint8_t>(result.max_height, top);
+
+            bool hole_below = false;
+            for (int y = 0; y < top; ++y) {
+                if (!filled(x, y)) {
+                    ++result.holes;
+                    hole_below = true;
+                } else if (hole_below) {
+                    ++result.covered_cells;
+                }
+            }
+        }
+
+        for (int x = 0; x < 9; ++x) {
+            result.bumpiness += std::abs(result.heights[x] - result.heights[x + 1]);
+        }
+
+        for (int y = 0; y < result.max_height; ++y) {
+            for (int x = 0; x <= 10; ++x) {
+                if (filled(x - 1, y) != filled(x, y)) {
+                    ++result.row_transitions;
+                }
+            }
+        }
+
+        for (int x = 0; x < 10; ++x) {
+            const auto left = 0 < x ? result.heights[x - 1] : height + 1;
+            const auto right = x < 9 ? result.heights[x + 1] : height + 1;
+            const auto depth = std::min(left, right) - result.heights[x];
+            if (result.well_depth < depth) {
+                result.well_depth = static_cast<uint8_t>(depth);
+                result.well_column = static_cast<uint8_t>(x);
+            }
+        }
+        return result;
+    }
+
+    template<typename Data>
+    void verify_corpus(const uint64_t seed) {
+        auto generator = s::corpus_generator{seed};
+        constexpr std::array<uint8_t, 4> heights{4, 8, 16, 20};
+        const auto corpus = generator.generate(8, heights);
+
+        std::vector<typename data<Data>::AlignedBoard> boards;
+        for (const auto &corpus_board: corpus) {
+            if (const auto board = corpus_board.template to_aligned<Data>()) {
+                boards.push_back(*board);
+            }
+        }
+        ASSERT_FALSE(boards.empty());
+
+        std::vector<board_features> batch(boards.size());
+        features<Data>::extract_batch(boards, batch);
+
+        for (size_t index = 0; index < boards.size(); ++index) {
+            const auto expected = scalar_features<Data>(boards[index].columns);
+            EXPECT_EQ(features<Data>::extract(boards[index]), expected) << "board " << index;
+            EXPECT_EQ(batch[index], expected) << "board " << index;
+        }
+    }
+
+    TEST_F(FeaturesTest, lemontea) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(lemontea);
+
+        const auto result = features<Data>::extract(board);
+        EXPECT_EQ(result.heights, (std::array<uint8_t, 10>{8, 6, 5, 4, 0, 1, 3, 5, 6, 6}));
+        EXPECT_EQ(result.max_height, 8);
+        EXPECT_EQ(result.holes, 1);
+        EXPECT_EQ(result.covered_cells, 2);
+        EXPECT_EQ(result.bumpiness, 2 + 1 + 1 + 4 + 1 + 2 + 2 + 1 + 0);
+        EXPECT_EQ(result.well_depth, 1);
+        EXPECT_EQ(result.well_column, 4);
+        EXPECT_EQ(result, scalar_features<Data>(board.columns));
+    }
+
+    TEST_F(FeaturesTest, empty) {
+        using Data = uint8_t;
+        const typename data<Data>::AlignedBoard board{};
+        const auto result = features<Data>::extract(board);
+        EXPECT_EQ(result, board_features{});
+    }
+
+    TEST_F(FeaturesTest, corpus_u8) {
+        verify_corpus<uint8_t>(1);
+    }
+
+    TEST_F(FeaturesTest, corpus_u16) {
+        verify_corpus<uint16_t>(2);
+    }
+
+    TEST_F(FeaturesTest, corpus_u32) {
+        verify_corpus<uint32_t>(3);
+    }
+
+    TEST_F(FeaturesTest, corpus_u64) {
+        verify_corpus<uint64_t>(4);
+    }
+
+    TEST_F(FeaturesTest, corpus_u128) {
+        verify_corpus<uint128_t>(5);
+    }
+}
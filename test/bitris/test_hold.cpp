@@ -0,0 +1,80 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "hold.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class HoldTest : public ::testing::Test {
+    };
+
+    TEST_F(HoldTest, swap_with_hold) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(lemontea);
+        const s::Spawn spawn{Orientation::North, 4, 20};
+        const std::vector<Shape> previews{Shape::S, Shape::Z};
+
+        const auto choices = s::search_with_hold<Data>(board, Shape::T, Shape::I, previews, spawn);
+        ASSERT_EQ(choices.size, 2);
+
+        const auto &current = choices.values[0];
+        EXPECT_EQ(current.choice, s::HoldChoice::Current);
+        EXPECT_EQ(current.shape, Shape::T);
+        EXPECT_EQ(current.next_hold, Shape::I);
+        EXPECT_EQ(current.consumed_previews, 0);
+        EXPECT_EQ(current.goals, s::search_shape<Data>(board, Shape::T, spawn));
+
+        const auto &held = choices.values[1];
+        EXPECT_EQ(held.choice, s::HoldChoice::Hold);
+        EXPECT_EQ(held.shape, Shape::I);
+        EXPECT_EQ(held.next_hold, Shape::T);
+        EXPECT_EQ(held.consumed_previews, 0);
+        EXPECT_EQ(held.goals, s::search_shape<Data>(board, Shape::I, spawn));
+    }
+
+    TEST_F(HoldTest, empty_hold_uses_preview) {
+        using Data = uint32_t;
+        const auto board = to_aligned<Data>(lemontea);
+        const s::Spawn spawn{Orientation::North, 4, 20};
+        const std::vector<Shape> previews{Shape::O, Shape::L};
+
+        const auto choices = s::search_with_hold<Data, true>(board, Shape::J, std::nullopt, previews, spawn);
+        ASSERT_EQ(choices.size, 2);
+        EXPECT_EQ(choices.values[0].next_hold, std::nullopt);
+        EXPECT_EQ(choices.values[0].goals, (s::search_shape<Data, true>(board, Shape::J, spawn)));
+
+        EXPECT_EQ(choices.values[1].shape, Shape::O);
+        EXPECT_EQ(choices.values[1].next_hold, Shape::J);
+        EXPECT_EQ(choices.values[1].consumed_previews, 1);
+        EXPECT_EQ(choices.values[1].goals, (s::search_shape<Data, true>(board, Shape::O, spawn)));
+    }
+
+    TEST_F(HoldTest, single_choice) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(lemontea);
+        const s::Spawn spawn{Orientation::North, 4, 20};
+
+        // ホールドと同じ形なら、ホールドしても状態は変わらない
+        const auto same = s::search_with_hold<Data>(board, Shape::S, Shape::S, {}, spawn);
+        EXPECT_EQ(same.size, 1);
+
+        // ホールドもネクストもなければ、ホールドできない
+        const auto none = s::search_with_hold<Data>(board, Shape::S, std::nullopt, {}, spawn);
+        EXPECT_EQ(none.size, 1);
+        EXPECT_EQ(none.values[0].goals, s::search_shape<Data>(board, Shape::S, spawn));
+
+        // ネクストの先頭が同じ形なら、置ける位置は同じで、ホールドだけが変わる
+        const std::vector<Shape> previews{Shape::S};
+        const auto preview = s::search_with_hold<Data>(board, Shape::S, std::nullopt, previews, spawn);
+        ASSERT_EQ(preview.size, 2);
+        EXPECT_EQ(preview.values[1].next_hold, Shape::S);
+        EXPECT_EQ(preview.values[1].goals, preview.values[0].goals);
+
+        size_t count = 0;
+        for (const auto &choice: preview) {
+            EXPECT_EQ(choice.shape, Shape::S);
+            ++count;
+        }
+        EXPECT_EQ(count, 2);
+    }
+}
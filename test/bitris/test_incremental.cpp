@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include "incremental.hpp"
+#include "line_clear.hpp"
+
+namespace core {
+    class IncrementalTest : public ::testing::Test {
+    };
+
+    // 親で到達できるすべての位置にミノを置き、子を最初から探索した結果と比べる
+    // 子からさらに1つ置いた孫も比べる
+    template<typename Data, Shape Shape>
+    void expect_children_equal_to_search(const typename data<Data>::type &board) {
+        using incremental = s::incremental_searcher<Data, Shape>;
+        using searcher = s::searcher<Data, Shape>;
+        using data_t = data<Data>;
+
+        const auto each_goal = [](const auto &goals, auto &&f) {
+            for (size_t orientation = 0; orientation < goals.size(); ++orientation) {
+                for (uint8_t x = 0; x < 10; ++x) {
+                    for (uint8_t y = 0; y < bits<Data>::bit_size; ++y) {
+                        if (goals[orientation][x] & (bits<Data>::one << y)) {
+                            f(static_cast<Orientation>(orientation), x, y);
+                        }
+                    }
+                }
+            }
+        };
+
+        typename incremental::state parent{};
+        const auto goals = incremental::execute(board, Orientation::North, 4, 20, parent);
+
+        size_t count = 0;
+        each_goal(goals, [&](const Orientation orientation, const uint8_t x, const uint8_t y) {
+            const auto child_board = line_clear<Data>::template put<Shape>(board, orientation, x, y);
+
+            typename incremental::state child{};
+            const auto actual = incremental::execute(parent, child_board, child);
+            const auto expected = searcher::execute(child_board, Orientation::North, 4, 20);
+            for (size_t index = 0; index < actual.size(); ++index) {
+                EXPECT_TRUE(data_t::is_equal_to(actual[index], expected[index]));
+            }
+
+            // 孫は子の1つ目の位置に置く
+            bool placed = false;
+            each_goal(actual, [&](const Orientation o, const uint8_t gx, const uint8_t gy) {
+                if (placed) {
+                    return;
+                }
+                placed = true;
+
+                const auto grandchild_board = line_clear<Data>::template put<Shape>(child_board, o, gx, gy);
+                typename incremental::state grandchild{};
+                const auto grandchild_actual = incremental::execute(child, grandchild_board, grandchild);
+                const auto grandchild_expected = searcher::execute(grandchild_board, Orientation::North, 4, 20);
+                for (size_t index = 0; index < grandchild_actual.size(); ++index) {
+                    EXPECT_TRUE(data_t::is_equal_to(grandchild_actual[index], grandchild_expected[index]));
+                }
+            });
+            ++count;
+        });
+        EXPECT_LT(0, count);
+    }
+
+    TEST_F(IncrementalTest, children_u32) {
+        using Data = uint32_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "XXXX..XXX."
+                "XXXXX.XXXX"
+                "......X..X"
+                ".........."
+                "...X......"
+                "....XX.X.X"
+                "XXX.X....."
+                "XX..X....X"
+                "X....X...."
+                "XX..XXXX.X"
+                "X....XX..."
+                "XX.XXX...."
+                ".......X.."
+                "......XXX."
+                "XX.X......"
+                "X....X...."
+                "X...X....X"
+                "X..XX.X.XX"
+                "XX..XXXXXX"
+        ).value();
+
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_children_equal_to_search<Data, Shape>(board);
+        });
+    }
+
+    TEST_F(IncrementalTest, children_u16) {
+        using Data = uint16_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "X........."
+                "X........."
+                "XX......XX"
+                "XXX....XXX"
+                "XXXX...XXX"
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        ).value();
+
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_children_equal_to_search<Data, Shape>(board);
+        });
+    }
+
+    TEST_F(IncrementalTest, line_clear_falls_back) {
+        using Data = uint16_t;
+        using incremental = s::incremental_searcher<Data, Shape::I>;
+        const auto board = data<Data>::from_str(
+                ""
+                "X........."
+                "XXXXXXXXX."
+        ).value();
+
+        typename incremental::state parent{};
+        incremental::execute(board, Orientation::North, 4, 10, parent);
+
+        // Iを縦に置いて1列消す
+        const auto placed = line_clear<Data>::put<Shape::I>(board, Orientation::West, 9, 1);
+        const auto cleared = line_clear<Data>::clear(placed);
+        ASSERT_EQ(cleared.cleared_lines, 1);
+
+        typename incremental::state child{};
+        const auto actual = incremental::execute(parent, cleared.board, child);
+        const auto expected = s::searcher<Data, Shape::I>::execute(cleared.board, Orientation::North, 4, 10);
+        for (size_t index = 0; index < actual.size(); ++index) {
+            EXPECT_TRUE(data<Data>::is_equal_to(actual[index], expected[index]));
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "search.hpp"
+
+namespace core {
+    class KicksTest : public ::testing::Test {
+    };
+
+    // 先頭のキックからの差分
+    template<size_t N>
+    std::vector<std::pair<int, int> > relative(const std::array<Offset, N> &kicks) {
+        std::vector<std::pair<int, int> > result;
+        for (const auto kick: kicks) {
+            result.emplace_back(kick.x - kicks[0].x, kick.y - kicks[0].y);
+        }
+        return result;
+    }
+
+    using Kicks = std::vector<std::pair<int, int> >;
+
+    TEST_F(KicksTest, rotate_to) {
+        static_assert(rotate_to(Orientation::North, Rotation::Cw) == Orientation::East);
+        static_assert(rotate_to(Orientation::North, Rotation::Ccw) == Orientation::West);
+        static_assert(rotate_to(Orientation::North, Rotation::Flip) == Orientation::South);
+        static_assert(rotate_to(Orientation::West, Rotation::Flip) == Orientation::East);
+    }
+
+    TEST_F(KicksTest, srs) {
+        static_assert(!srs_kicks::has_flip);
+
+        EXPECT_EQ(relative(srs_kicks::get<{Shape::T, Orientation::North}, Rotation::Cw>()),
+                  (Kicks{{0, 0}, {-1, 0}, {-1, 1}, {0, -2}, {-1, -2}}));
+        EXPECT_EQ(relative(srs_kicks::get<{Shape::J, Orientation::West}, Rotation::Ccw>()),
+                  (Kicks{{0, 0}, {-1, 0}, {-1, -1}, {0, 2}, {-1, 2}}));
+        EXPECT_EQ(relative(srs_kicks::get<{Shape::I, Orientation::North}, Rotation::Cw>()),
+                  (Kicks{{0, 0}, {-2, 0}, {1, 0}, {-2, -1}, {1, 2}}));
+        EXPECT_EQ(relative(srs_kicks::get<{Shape::I, Orientation::East}, Rotation::Cw>()),
+                  (Kicks{{0, 0}, {-1, 0}, {2, 0}, {-1, 2}, {2, -1}}));
+    }
+
+    TEST_F(KicksTest, srs_flip) {
+        static_assert(srs_flip_kicks::has_flip);
+
+        // 90度回転はSRSと同じ
+        static_for_t<{Shape::T, Shape::I, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                    [&]<Orientation Orientation>() {
+                        static_for_t<{Rotation::Cw, Rotation::Ccw}>([&]<Rotation R>() {
+                            const auto expected = srs_kicks::get<{Shape, Orientation}, R>();
+                            const auto actual = srs_flip_kicks::get<{Shape, Orientation}, R>();
+                            EXPECT_EQ(relative(actual), relative(expected));
+                        });
+                    });
+        });
+
+        EXPECT_EQ(relative(srs_flip_kicks::get<{Shape::T, Orientation::North}, Rotation::Flip>()),
+                  (Kicks{{0, 0}, {0, 1}, {1, 1}, {-1, 1}, {1, 0}, {-1, 0}}));
+        EXPECT_EQ(relative(srs_flip_kicks::get<{Shape::S, Orientation::East}, Rotation::Flip>()),
+                  (Kicks{{0, 0}, {1, 0}, {1, 2}, {1, 1}, {0, 2}, {0, 1}}));
+        EXPECT_EQ(relative(srs_flip_kicks::get<{Shape::L, Orientation::South}, Rotation::Flip>()),
+                  (Kicks{{0, 0}, {0, -1}, {-1, -1}, {1, -1}, {-1, 0}, {1, 0}}));
+        EXPECT_EQ(relative(srs_flip_kicks::get<{Shape::I, Orientation::West}, Rotation::Flip>()),
+                  (Kicks{{0, 0}, {-1, 0}, {-1, 2}, {-1, 1}, {0, 2}, {0, 1}}));
+
+        // Iは4x4の枠の中で回転するため、NorthとSouthは同じ列を占める
+        const auto i_flip = srs_flip_kicks::get<{Shape::I, Orientation::North}, Rotation::Flip>();
+        EXPECT_EQ(i_flip[0].x, 1);
+        EXPECT_EQ(i_flip[0].y, -1);
+    }
+
+    TEST_F(KicksTest, search_srs_flip_reaches_more) {
+        using Data = uint8_t;
+        const auto board = data<Data>::from_str(
+                ""
+                ".....X...."
+                ".....X...."
+                ".........."
+                "...X......"
+                "XX..X.X..."
+        ).value();
+
+        const auto srs = s::searcher<Data, Shape::T>::execute(board, Orientation::North, 4, 6);
+        const auto flip = s::searcher<Data, Shape::T, false, Movement::Srs, srs_flip_kicks>::execute(
+                board, Orientation::North, 4, 6
+        );
+
+        // 180度回転で上にキックしたSouthの位置だけが増える
+        constexpr auto south = static_cast<size_t>(Orientation::South);
+        for (size_t index = 0; index < 4; ++index) {
+            auto added = flip[index] & ~srs[index];
+            EXPECT_TRUE(data<Data>::is_equal_to(srs[index] & ~flip[index], 0));
+            if (index == south) {
+                EXPECT_EQ(added[5], bits<Data>::one << 6);
+                added[5] = 0;
+            }
+            EXPECT_TRUE(data<Data>::is_equal_to(added, 0));
+        }
+    }
+}
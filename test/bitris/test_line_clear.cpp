@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "line_clear.hpp"
+
+namespace core {
+    class LineClearTest : public ::testing::Test {
+    };
+
+    TEST_F(LineClearTest, filled_rows_u8) {
+        using Data = uint8_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "XXXXXXXXXX"
+                "XXXX.XXXXX"
+                "XXXXXXXXXX"
+        ).value();
+        EXPECT_EQ(line_clear<Data>::filled_rows(board), 0b101);
+    }
+
+    TEST_F(LineClearTest, clear_no_lines_u8) {
+        using Data = uint8_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "XXXX.XXXXX"
+                "XXX.XXXXXX"
+        ).value();
+        const auto result = line_clear<Data>::clear(board);
+        EXPECT_EQ(result.cleared_lines, 0);
+        EXPECT_TRUE(data<Data>::is_equal_to(result.board, board));
+    }
+
+    TEST_F(LineClearTest, clear_u16) {
+        using Data = uint16_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "X........."
+                "XXXXXXXXXX"
+                ".X.X......"
+                "XXXXXXXXXX"
+                "XXXXXXXXXX"
+                "XXXX.XXXXX"
+        ).value();
+        const auto expected = data<Data>::from_str(
+                ""
+                "X........."
+                ".X.X......"
+                "XXXX.XXXXX"
+        ).value();
+        const auto result = line_clear<Data>::clear(board);
+        EXPECT_EQ(result.cleared_lines, 3);
+        EXPECT_TRUE(data<Data>::is_equal_to(result.board, expected));
+    }
+
+    TEST_F(LineClearTest, put_and_clear_tspin_double_u32) {
+        using Data = uint32_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+                "XXX..XXXXX"
+        ).value();
+        const auto expected = data<Data>::from_str(
+                ""
+                "XXX..XXXXX"
+        ).value();
+        const auto result = line_clear<Data>::put_and_clear<Shape::T>(board, Orientation::South, 4, 2);
+        EXPECT_EQ(result.cleared_lines, 2);
+        EXPECT_TRUE(data<Data>::is_equal_to(result.board, expected));
+    }
+
+    TEST_F(LineClearTest, put_i_tetris_u64) {
+        using Data = uint64_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "X........."
+        ).value();
+        const auto expected = data<Data>::from_str(
+                ""
+                "X........."
+        ).value();
+        const auto result = line_clear<Data>::put_and_clear<Shape::I>(board, Orientation::West, 9, 2);
+        EXPECT_EQ(result.cleared_lines, 4);
+        EXPECT_TRUE(data<Data>::is_equal_to(result.board, expected));
+    }
+
+    TEST_F(LineClearTest, put_all_shapes_fill_four_cells_u8) {
+        using Data = uint8_t;
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            for (const auto orientation: {
+                     Orientation::North, Orientation::East, Orientation::South, Orientation::West
+                 }) {
+                const auto placed = line_clear<Data>::put<Shape>(data<Data>::make_zero(), orientation, 4, 3);
+                size_t count = 0;
+                for (size_t x = 0; x < 10; ++x) {
+                    count += std::popcount(placed[x]);
+                }
+                EXPECT_EQ(count, 4);
+            }
+        });
+    }
+}
@@ -0,0 +1,155 @@
+#include <set>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "lookahead.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class LookaheadTest : public ::testing::Test {
+    };
+
+    // 消した行の数が多く、同じならブロックが低いほど良い
+    template<typename Data>
+    struct lines_then_height {
+        int operator()(const s::Leaf<Data> &leaf) const {
+            int height = 0;
+            for (const auto column: leaf.board.columns) {
+                height = std::max(height, static_cast<int>(std::bit_width(column)));
+            }
+            return static_cast<int>(leaf.cleared_lines) * 100 - height;
+        }
+    };
+
+    TEST_F(LookaheadTest, tetris_with_i) {
+        using Data = uint8_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+        );
+        const std::vector<Shape> queue{Shape::I};
+
+        s::lookahead_searcher<Data, lines_then_height<Data> > searcher{{}};
+        const auto result = searcher.search(board, queue, std::nullopt, 1);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result->depth, 1);
+        EXPECT_EQ(result->score, 400);
+        EXPECT_EQ(result->move.shape, Shape::I);
+        EXPECT_EQ(result->move.placement.x, 9);
+        EXPECT_FALSE(result->move.hold);
+    }
+
+    TEST_F(LookaheadTest, uses_hold_from_preview) {
+        using Data = uint8_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+        );
+        const std::vector<Shape> queue{Shape::S, Shape::I};
+
+        s::lookahead_searcher<Data, lines_then_height<Data> > searcher{{}};
+        const auto result = searcher.search(board, queue, std::nullopt, 1);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result->score, 400);
+        EXPECT_EQ(result->move.shape, Shape::I);
+        EXPECT_TRUE(result->move.hold);
+
+        // ホールドを使わなければ、Sしか置けない
+        const auto without_hold = searcher.search(board, queue, std::nullopt, 1, false);
+        ASSERT_TRUE(without_hold.has_value());
+        EXPECT_EQ(without_hold->move.shape, Shape::S);
+        EXPECT_LT(without_hold->score, 400);
+    }
+
+    TEST_F(LookaheadTest, finds_setup_two_pieces_ahead) {
+        using Data = uint8_t;
+        // Oを左下に置いてから、Iを縦に置くと4段消える
+        const auto board = to_aligned<Data>(
+                ""
+                "..XXXXXX.X"
+                "..XXXXXX.X"
+                "XXXXXXXX.X"
+                "XXXXXXXX.X"
+        );
+        const std::vector<Shape> queue{Shape::O, Shape::I};
+
+        s::lookahead_searcher<Data, lines_then_height<Data> > searcher{{}};
+        const auto result = searcher.search(board, queue, std::nullopt, 2, false);
+        ASSERT_TRUE(result.has_value());
+        EXPECT_EQ(result->depth, 2);
+        EXPECT_EQ(result->score, 400);
+        EXPECT_EQ(result->move.shape, Shape::O);
+        EXPECT_EQ(result->move.placement.x, 0);
+        EXPECT_EQ(result->move.placement.y, 2);
+    }
+
+    TEST_F(LookaheadTest, merges_duplicate_boards) {
+        using Data = uint8_t;
+        const typename data<Data>::AlignedBoard board{};
+        const std::vector<Shape> queue{Shape::O, Shape::O};
+
+        // 2つのOを置いてできる盤面を、重複を除いて数える
+        const auto extract = [](const typename data<Data>::AlignedBoard &current) {
+            const auto goals = s::search_shape<Data>(current, Shape::O, {Orientation::North, 4, 20});
+            std::array<Data, 10> o_goals{};
+            std::copy_n(goals.begin(), 10, o_goals.begin());
+            return placements<Data, Shape::O>::extract<false>(o_goals);
+        };
+
+        std::set<std::array<Data, 10> > expected;
+        const auto first = extract(board);
+        for (const auto &p1: first) {
+            const auto board1 = line_clear<Data>::put<Shape::O>(data<Data>::load(board), p1.orientation, p1.x, p1.y);
+            typename data<Data>::AlignedBoard aligned1{};
+            board1.copy_to(aligned1.columns.data(), stdx::vector_aligned);
+
+            for (const auto &p2: extract(aligned1)) {
+                // 一番上の段を超える置き方は除く
+                if (8 <= p2.y + 1) {
+                    continue;
+                }
+                const auto board2 = line_clear<Data>::put<Shape::O>(board1, p2.orientation, p2.x, p2.y);
+                std::array<Data, 10> columns{};
+                board2.copy_to(columns.data(), stdx::element_aligned);
+                expected.insert(columns);
+            }
+        }
+
+        const auto count = [](const s::Leaf<Data> &) { return 0; };
+        s::lookahead_searcher<Data, decltype(count)> searcher{count};
+        const auto result = searcher.search(board, queue, std::nullopt, 2, false);
+        ASSERT_TRUE(result.has_value());
+
+        const auto &stats = searcher.last_stats();
+        EXPECT_EQ(stats.leaves, expected.size());
+        EXPECT_LT(0, stats.duplicates);
+        EXPECT_EQ(stats.nodes, first.size + expected.size());
+    }
+
+    TEST_F(LookaheadTest, no_placement) {
+        using Data = uint8_t;
+        // spawnの位置が埋まっていて、どこにも置けない
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXXXXXXX."
+                "XXXXXXXX.X"
+                "XXXXXXX.XX"
+                "XXXXXX.XXX"
+                "XXXXX.XXXX"
+                "XXXX.XXXXX"
+                "XXX.XXXXXX"
+                "XX.XXXXXXX"
+        );
+        const std::vector<Shape> queue{Shape::O};
+
+        const auto count = [](const s::Leaf<Data> &) { return 0; };
+        s::lookahead_searcher<Data, decltype(count)> searcher{count, {Orientation::North, 4, 6}};
+        EXPECT_FALSE(searcher.search(board, queue, std::nullopt, 1).has_value());
+    }
+}
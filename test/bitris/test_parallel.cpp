@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "parallel.hpp"
+
+namespace core {
+    class ParallelTest : public ::testing::Test {
+    };
+
+    template<typename Data>
+    std::vector<s::Job<Data> > make_jobs(const size_t count) {
+        const auto board = data<Data>::from_str(
+                ""
+                "X........."
+                "X........."
+                "XX......XX"
+                "XXX....XXX"
+                "XXXX...XXX"
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        ).value();
+
+        std::vector<s::Job<Data> > jobs(count);
+        for (size_t index = 0; index < count; ++index) {
+            auto &job = jobs[index];
+            board.copy_to(job.board.columns.data(), stdx::vector_aligned);
+            // ジョブごとに盤面・形・spawnを変える
+            job.board.columns[index % 10] |= bits<Data>::one << (index % 7);
+            job.shape = static_cast<Shape>(index % 7);
+            job.spawn = {static_cast<Orientation>(index % 4), 4, 12};
+        }
+        return jobs;
+    }
+
+    template<typename Data>
+    void expect_same_as_serial(const size_t thread_count, const size_t job_count) {
+        using parallel = s::parallel_searcher<Data>;
+
+        const auto jobs = make_jobs<Data>(job_count);
+        std::vector<typename parallel::result_t> out(jobs.size());
+
+        parallel searcher{thread_count};
+        EXPECT_EQ(searcher.thread_count(), std::max<size_t>(1, thread_count));
+
+        // 同じsearcherを繰り返し使っても結果が変わらない
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            std::fill(out.begin(), out.end(), typename parallel::result_t{});
+            searcher.search(jobs, out);
+            for (size_t index = 0; index < jobs.size(); ++index) {
+                EXPECT_EQ(out[index], parallel::search_one(jobs[index])) << "index=" << index;
+            }
+        }
+    }
+
+    TEST_F(ParallelTest, search_one_thread) {
+        expect_same_as_serial<uint16_t>(1, 50);
+    }
+
+    TEST_F(ParallelTest, search_multiple_threads) {
+        expect_same_as_serial<uint16_t>(4, 203);
+        expect_same_as_serial<uint32_t>(3, 97);
+    }
+
+    TEST_F(ParallelTest, search_fewer_jobs_than_threads) {
+        expect_same_as_serial<uint8_t>(8, 3);
+        expect_same_as_serial<uint8_t>(4, 0);
+    }
+
+    TEST_F(ParallelTest, search_one_matches_searcher) {
+        using Data = uint16_t;
+        const auto jobs = make_jobs<Data>(7);
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            const auto &job = jobs[static_cast<size_t>(Shape)];
+            const auto expected = s::searcher<Data, Shape>::search(
+                    job.board, job.spawn.orientation, job.spawn.cx, job.spawn.cy
+            );
+            const auto result = s::parallel_searcher<Data>::search_one(job);
+            for (size_t index = 0; index < result.size(); ++index) {
+                EXPECT_EQ(result[index], index < expected.size() ? expected[index] : 0);
+            }
+        });
+    }
+}
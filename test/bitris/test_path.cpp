@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include "search.hpp"
+#include "path.hpp"
+
+namespace core {
+    class PathTest : public ::testing::Test {
+    };
+
+    // 操作を1つずつ適用して、たどり着いた位置を返す。不正な操作があればnullopt
+    template<typename Data, Shape Shape>
+    std::optional<Placement> replay(
+            const typename data<Data>::type &board,
+            Placement current,
+            const std::vector<Input> &inputs
+    ) {
+        const auto all_free_space = free_spaces<Data, Shape>::get(~board);
+        const auto is_free = [&](const Orientation orientation, const int x, const int y) {
+            if (x < 0 || 10 <= x || y < 0 || static_cast<int>(bits<Data>::bit_size) <= y) {
+                return false;
+            }
+            return (all_free_space[static_cast<size_t>(orientation)][x] & (bits<Data>::one << y)) != 0;
+        };
+
+        for (const auto input: inputs) {
+            int x = current.x;
+            int y = current.y;
+            auto orientation = current.orientation;
+            switch (input) {
+                case Input::Left:
+                    x -= 1;
+                    break;
+                case Input::Right:
+                    x += 1;
+                    break;
+                case Input::SoftDrop:
+                    y -= 1;
+                    break;
+                case Input::Cw:
+                case Input::Ccw: {
+                    bool rotated = false;
+                    static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                            [&]<Orientation From>() {
+                                static_for_t<{Rotation::Cw, Rotation::Ccw}>([&]<Rotation R>() {
+                                    const auto expected_input = R == Rotation::Cw ? Input::Cw : Input::Ccw;
+                                    if (rotated || From != current.orientation || input != expected_input) {
+                                        return;
+                                    }
+                                    constexpr auto to = rotate_to(From, R);
+                                    for (const auto offset: get_offsets<{Shape, From}, R>()) {
+                                        if (is_free(to, x + offset.x, y + offset.y)) {
+                                            x += offset.x;
+                                            y += offset.y;
+                                            orientation = to;
+                                            rotated = true;
+                                            return;
+                                        }
+                                    }
+                                });
+                            });
+                    if (!rotated) {
+                        return std::nullopt;
+                    }
+                    break;
+                }
+                case Input::Flip:
+                    // SRSのキックのみを再現するため、180度回転は不正な操作とする
+                    return std::nullopt;
+            }
+            if (!is_free(orientation, x, y)) {
+                return std::nullopt;
+            }
+            current = {orientation, static_cast<uint8_t>(x), static_cast<uint8_t>(y)};
+        }
+        return current;
+    }
+
+    TEST_F(PathTest, reconstruct_empty_t) {
+        using Data = uint8_t;
+        constexpr auto shape = Shape::T;
+        const auto board = data<Data>::make_zero();
+        const auto layers = path_finder<Data, shape>::execute(board, Orientation::North, 4, 6);
+
+        const auto inputs = path_finder<Data, shape>::reconstruct(layers, {Orientation::North, 1, 0});
+        ASSERT_TRUE(inputs.has_value());
+        EXPECT_EQ(inputs->size(), 9);
+
+        const auto actual = replay<Data, shape>(board, {Orientation::North, 4, 6}, *inputs);
+        EXPECT_EQ(actual, (Placement{Orientation::North, 1, 0}));
+    }
+
+    TEST_F(PathTest, reconstruct_unreachable) {
+        using Data = uint8_t;
+        constexpr auto shape = Shape::T;
+        const auto board = data<Data>::from_str(
+                ""
+                "XXXXXXXXX."
+                "XXXXXXXXX."
+                "........X."
+        ).value();
+        const auto layers = path_finder<Data, shape>::execute(board, Orientation::North, 4, 6);
+        const auto inputs = path_finder<Data, shape>::reconstruct(layers, {Orientation::North, 1, 0});
+        EXPECT_FALSE(inputs.has_value());
+    }
+
+    TEST_F(PathTest, reconstruct_tspin_double) {
+        using Data = uint16_t;
+        constexpr auto shape = Shape::T;
+        const auto board = data<Data>::from_str(
+                ""
+                "XX........"
+                "X........."
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        ).value();
+        const auto layers = path_finder<Data, shape>::execute(board, Orientation::North, 4, 10);
+
+        const auto goal = Placement{Orientation::South, 4, 1};
+        const auto inputs = path_finder<Data, shape>::reconstruct(layers, goal);
+        ASSERT_TRUE(inputs.has_value());
+        EXPECT_TRUE(inputs->back() == Input::Cw || inputs->back() == Input::Ccw);
+
+        const auto actual = replay<Data, shape>(board, {Orientation::North, 4, 10}, *inputs);
+        EXPECT_EQ(actual, goal);
+    }
+
+    // 到達できる位置はsearcherのgoalと一致し、すべてのgoalに正しい手順が復元できる
+    template<typename Data, Shape Shape>
+    void expect_all_goals_reconstructed(const typename data<Data>::type &board) {
+        const auto goals = s::searcher<Data, Shape>::execute(board, Orientation::North, 4, 10);
+        const auto layers = path_finder<Data, Shape>::execute(board, Orientation::North, 4, 10);
+
+        std::array<Data, free_spaces<Data, Shape>::N * 10> goal_array{};
+        for (size_t index = 0; index < goals.size(); ++index) {
+            goals[index].copy_to(&goal_array[index * 10], stdx::element_aligned);
+        }
+
+        size_t count = 0;
+        for (const auto &goal: placements<Data, Shape>::template extract<false>(goal_array)) {
+            const auto inputs = path_finder<Data, Shape>::reconstruct(layers, goal);
+            ASSERT_TRUE(inputs.has_value());
+
+            const auto actual = replay<Data, Shape>(board, {Orientation::North, 4, 10}, *inputs);
+            EXPECT_EQ(actual, goal);
+            ++count;
+        }
+        EXPECT_LT(0, count);
+    }
+
+    TEST_F(PathTest, reconstruct_all_goals) {
+        using Data = uint16_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "X........."
+                "X......X.."
+                "XX...X.XXX"
+                "XXX....XXX"
+                "XXXX...XXX"
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        ).value();
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_all_goals_reconstructed<Data, Shape>(board);
+        });
+    }
+
+    TEST_F(PathTest, reconstruct_flip) {
+        using Data = uint8_t;
+        using finder = path_finder<Data, Shape::T, srs_flip_kicks>;
+        const auto board = data<Data>::from_str(
+                ""
+                ".....X...."
+                ".....X...."
+                ".........."
+                "...X......"
+                "XX..X.X..."
+        ).value();
+        const auto layers = finder::execute(board, Orientation::North, 4, 6);
+
+        const auto inputs = finder::reconstruct(layers, {Orientation::South, 5, 6});
+        ASSERT_TRUE(inputs.has_value());
+        EXPECT_EQ(inputs->back(), Input::Flip);
+    }
+}
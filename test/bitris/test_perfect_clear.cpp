@@ -0,0 +1,136 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "perfect_clear.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class PerfectClearTest : public ::testing::Test {
+    };
+
+    // 解の通りに置いて、盤面が空になるか
+    template<typename Data>
+    bool replays_to_empty(
+            const typename data<Data>::AlignedBoard &board,
+            const s::perfect_clear_finder::solution &solution
+    ) {
+        auto current = data<Data>::load(board);
+        for (const auto &move: solution) {
+            current = s::dispatch_shape(move.shape, [&]<Shape Shape>() {
+                return line_clear<Data>::template put_and_clear<Shape>(
+                        current, move.placement.orientation, move.placement.x, move.placement.y
+                ).board;
+            });
+        }
+        return data<Data>::is_equal_to(current, Data{0});
+    }
+
+    TEST_F(PerfectClearTest, single_piece) {
+        using Data = uint8_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXXXXXX.."
+                "XXXXXXXX.."
+        );
+        const s::perfect_clear_finder finder{1};
+
+        const std::vector<Shape> o{Shape::O};
+        EXPECT_TRUE(finder.exists(board, o, std::nullopt, 2));
+        const auto solutions = finder.find_all(board, o, std::nullopt, 2);
+        ASSERT_EQ(solutions.size(), 1);
+        ASSERT_EQ(solutions[0].size(), 1);
+        EXPECT_EQ(solutions[0][0].shape, Shape::O);
+        EXPECT_FALSE(solutions[0][0].hold);
+        EXPECT_TRUE(replays_to_empty<Data>(board, solutions[0]));
+
+        const std::vector<Shape> i{Shape::I};
+        EXPECT_FALSE(finder.exists(board, i, std::nullopt, 2));
+        EXPECT_TRUE(finder.find_all(board, i, std::nullopt, 2).empty());
+    }
+
+    TEST_F(PerfectClearTest, uses_hold) {
+        using Data = uint8_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXXXXXX.."
+                "XXXXXXXX.."
+        );
+        const s::perfect_clear_finder finder{1};
+
+        // ホールドが空なら、ネクストのOを使う
+        const std::vector<Shape> queue{Shape::I, Shape::O};
+        const auto solutions = finder.find_all(board, queue, std::nullopt, 2);
+        ASSERT_EQ(solutions.size(), 1);
+        EXPECT_EQ(solutions[0][0].shape, Shape::O);
+        EXPECT_TRUE(solutions[0][0].hold);
+
+        // ホールドにあるOを使う
+        const std::vector<Shape> current{Shape::I};
+        EXPECT_TRUE(finder.exists(board, current, Shape::O, 2));
+    }
+
+    TEST_F(PerfectClearTest, rejects_impossible_boards) {
+        using Data = uint8_t;
+        const s::perfect_clear_finder finder{1};
+        const std::vector<Shape> queue{Shape::O, Shape::O, Shape::O};
+
+        // 空いているマスが4の倍数でない
+        EXPECT_FALSE(finder.exists(to_aligned<Data>("XXXXXXXX.X"), queue, std::nullopt, 1));
+
+        // 天井より上にブロックがある
+        EXPECT_FALSE(finder.exists(to_aligned<Data>(""
+                                                  "X........."
+                                                  "XXXXXXXX.."
+                                                  "XXXXXXXX.."), queue, std::nullopt, 2));
+
+        // ミノが足りない
+        EXPECT_FALSE(finder.exists(to_aligned<Data>(""
+                                                  "XXXXXX...."
+                                                  "XXXXXX...."), std::vector{Shape::O}, std::nullopt, 2));
+    }
+
+    TEST_F(PerfectClearTest, four_lines) {
+        using Data = uint8_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXXXX...."
+                "XXXXXX...."
+                "XXXXXX...."
+                "XXXXXX...."
+        );
+        const std::vector<Shape> queue{Shape::I, Shape::I, Shape::I, Shape::I, Shape::O};
+
+        const s::perfect_clear_finder single{1};
+        const auto solutions = single.find_all(board, queue, std::nullopt, 4);
+        ASSERT_FALSE(solutions.empty());
+        for (const auto &solution: solutions) {
+            EXPECT_EQ(solution.size(), 4);
+            EXPECT_TRUE(replays_to_empty<Data>(board, solution));
+        }
+
+        // スレッドに分けても、同じ解が同じ順に見つかる
+        const s::perfect_clear_finder parallel{4};
+        EXPECT_EQ(parallel.find_all(board, queue, std::nullopt, 4), solutions);
+        EXPECT_TRUE(parallel.exists(board, queue, std::nullopt, 4));
+    }
+
+    TEST_F(PerfectClearTest, empty_board) {
+        using Data = uint8_t;
+        const typename data<Data>::AlignedBoard board{};
+        const s::perfect_clear_finder finder{4};
+
+        const std::vector<Shape> two_lines{Shape::I, Shape::O, Shape::I, Shape::O, Shape::O};
+        const auto solutions = finder.find_all(board, two_lines, std::nullopt, 2);
+        ASSERT_FALSE(solutions.empty());
+        for (const auto &solution: solutions) {
+            EXPECT_EQ(solution.size(), 5);
+            EXPECT_TRUE(replays_to_empty<Data>(board, solution));
+        }
+
+        const std::vector<Shape> four_lines{
+                Shape::I, Shape::L, Shape::J, Shape::O, Shape::S, Shape::Z, Shape::T,
+                Shape::L, Shape::J, Shape::O, Shape::I,
+        };
+        EXPECT_TRUE(finder.exists(board, four_lines, std::nullopt, 4));
+    }
+}
@@ -0,0 +1,94 @@
+#include <set>
+#include <gtest/gtest.h>
+
+#include "search.hpp"
+#include "line_clear.hpp"
+#include "placements.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class PlacementsTest : public ::testing::Test {
+    };
+
+    // 置き場所ごとに、ミノが占めるブロックの集合を返す
+    template<typename Data, Shape Shape>
+    std::vector<std::array<Data, 10> > to_blocks(const typename placements<Data, Shape>::list &list) {
+        std::vector<std::array<Data, 10> > blocks;
+        for (const auto &placement: list) {
+            const auto placed = line_clear<Data>::template put<Shape>(
+                    data<Data>::make_zero(), placement.orientation, placement.x, placement.y
+            );
+            std::array<Data, 10> array{};
+            placed.copy_to(array.data(), stdx::element_aligned);
+            blocks.push_back(array);
+        }
+        return blocks;
+    }
+
+    TEST_F(PlacementsTest, extract_t_empty) {
+        using Data = uint8_t;
+        constexpr auto shape = Shape::T;
+        const auto board = typename data<Data>::AlignedBoard{};
+        const auto goals = s::searcher<Data, shape>::search(board, Orientation::North, 4, 6);
+        const auto list = placements<Data, shape>::extract(goals);
+
+        EXPECT_EQ(list.size, 34);
+        for (const auto &placement: list) {
+            // 床に接している
+            switch (placement.orientation) {
+                case Orientation::North:
+                    EXPECT_EQ(placement.y, 0);
+                    break;
+                default:
+                    EXPECT_EQ(placement.y, 1);
+            }
+        }
+    }
+
+    TEST_F(PlacementsTest, extract_keeps_order) {
+        using Data = uint8_t;
+        constexpr auto shape = Shape::O;
+        std::array<Data, 10> goals{};
+        goals[3] = 0b1010;
+        goals[1] = 0b0001;
+        const auto list = placements<Data, shape>::extract(goals);
+
+        ASSERT_EQ(list.size, 3);
+        EXPECT_EQ(list.values[0], (Placement{Orientation::North, 1, 0}));
+        EXPECT_EQ(list.values[1], (Placement{Orientation::North, 3, 1}));
+        EXPECT_EQ(list.values[2], (Placement{Orientation::North, 3, 3}));
+    }
+
+    template<typename Data, Shape Shape>
+    void expect_canonical_is_unique() {
+        const auto board = to_aligned<Data>(
+                ""
+                "X.....X..."
+                "XX...XXX.."
+                "XXX..XXXX."
+                "XXXX.XXXXX"
+        );
+        const auto goals = s::searcher<Data, Shape>::search(board, Orientation::North, 4, 6);
+
+        const auto all = to_blocks<Data, Shape>(placements<Data, Shape>::template extract<false>(goals));
+        const auto canonical = to_blocks<Data, Shape>(placements<Data, Shape>::extract(goals));
+
+        const auto all_set = std::set(all.begin(), all.end());
+        const auto canonical_set = std::set(canonical.begin(), canonical.end());
+        EXPECT_EQ(canonical.size(), canonical_set.size());
+        EXPECT_EQ(canonical_set, all_set);
+        EXPECT_LT(canonical.size(), all.size());
+    }
+
+    TEST_F(PlacementsTest, extract_canonical_s) {
+        expect_canonical_is_unique<uint8_t, Shape::S>();
+    }
+
+    TEST_F(PlacementsTest, extract_canonical_z) {
+        expect_canonical_is_unique<uint16_t, Shape::Z>();
+    }
+
+    TEST_F(PlacementsTest, extract_canonical_i) {
+        expect_canonical_is_unique<uint32_t, Shape::I>();
+    }
+}
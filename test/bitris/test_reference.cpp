@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "search.hpp"
+#include "corpus.hpp"
+#include "reference.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class ReferenceTest : public ::testing::Test {
+    };
+
+    // 環境変数 BITRIS_FUZZ_ITERATIONS で、ランダムな盤面の数を増やせる
+    size_t fuzz_iterations() {
+        if (const auto *value = std::getenv("BITRIS_FUZZ_ITERATIONS")) {
+            return std::strtoull(value, nullptr, 10);
+        }
+        return 16;
+    }
+
+    // 浮いたブロックや屋根が多い、ランダムな盤面
+    template<typename Data>
+    std::array<Data, 10> random_board(std::mt19937_64 &engine) {
+        constexpr auto bit_size = bits<Data>::bit_size;
+        const auto height = engine() % (bit_size + 1);
+        const auto mask = height == bit_size ? bits<Data>::full : static_cast<Data>((bits<Data>::one << height) - 1);
+
+        std::array<Data, 10> board{};
+        for (auto &column: board) {
+            Data bits = 0;
+            for (size_t word = 0; word * 64 < bit_size; ++word) {
+                bits |= static_cast<Data>(static_cast<Data>(engine() & engine()) << (word * 64));
+            }
+            column = bits & mask;
+        }
+        return board;
+    }
+
+    template<typename Data, Shape Shape, typename Kicks>
+    void expect_equal_to_reference(const std::array<Data, 10> &columns, const s::Spawn &spawn) {
+        typename data<Data>::AlignedBoard board{};
+        board.columns = columns;
+
+        const auto expected = reference_searcher<Data, Shape, Kicks>::search(
+                columns, spawn.orientation, spawn.cx, spawn.cy
+        );
+        const auto actual = s::searcher<Data, Shape, false, Movement::Srs, Kicks>::search(
+                board, spawn.orientation, spawn.cx, spawn.cy
+        );
+        ASSERT_TRUE(actual == expected)
+                                    << "shape=" << static_cast<int>(Shape)
+                                    << " spawn=(" << static_cast<int>(spawn.orientation) << ", "
+                                    << static_cast<int>(spawn.cx) << ", " << static_cast<int>(spawn.cy) << ")";
+    }
+
+    template<typename Data, typename Kicks = srs_kicks>
+    void expect_all_equal_to_reference(const uint64_t seed) {
+        constexpr auto bit_size = bits<Data>::bit_size;
+        auto engine = std::mt19937_64{seed};
+
+        std::vector<std::array<Data, 10> > boards;
+        auto generator = s::corpus_generator{seed};
+        for (const auto &corpus_board: generator.generate(2, std::array<uint8_t, 3>{4, 8, 20})) {
+            if (const auto board = corpus_board.to_aligned<Data>()) {
+                boards.push_back(board->columns);
+            }
+        }
+        for (size_t index = 0; index < fuzz_iterations(); ++index) {
+            boards.push_back(random_board<Data>(engine));
+        }
+
+        for (const auto &board: boards) {
+            // 盤面より上のspawnと、盤面の中のランダムなspawn
+            const auto orientation = static_cast<Orientation>(engine() % 4);
+            const auto cx = static_cast<uint8_t>(engine() % 10);
+            const auto cy = static_cast<uint8_t>(engine() % (bit_size + 2));
+            static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+                expect_equal_to_reference<Data, Shape, Kicks>(board, {Orientation::North, 4, 20});
+                expect_equal_to_reference<Data, Shape, Kicks>(board, {orientation, cx, cy});
+            });
+        }
+    }
+
+    TEST_F(ReferenceTest, lemontea) {
+        using Data = uint16_t;
+        const auto columns = to_aligned<Data>(lemontea).columns;
+
+        // T-Spin Tripleの位置に届く
+        const auto goals = reference_searcher<Data, Shape::T>::search(columns, Orientation::North, 4, 20);
+        EXPECT_NE(goals[static_cast<size_t>(Orientation::South) * 10 + 4] & 0b10, 0);
+
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_equal_to_reference<Data, Shape, srs_kicks>(columns, {Orientation::North, 4, 20});
+        });
+    }
+
+    TEST_F(ReferenceTest, random_u8) {
+        expect_all_equal_to_reference<uint8_t>(1);
+    }
+
+    TEST_F(ReferenceTest, random_u16) {
+        expect_all_equal_to_reference<uint16_t>(2);
+    }
+
+    TEST_F(ReferenceTest, random_u32) {
+        expect_all_equal_to_reference<uint32_t>(3);
+    }
+
+    TEST_F(ReferenceTest, random_u64) {
+        expect_all_equal_to_reference<uint64_t>(4);
+    }
+
+    TEST_F(ReferenceTest, random_u128) {
+        expect_all_equal_to_reference<uint128_t>(5);
+    }
+
+    TEST_F(ReferenceTest, random_flip_u16) {
+        expect_all_equal_to_reference<uint16_t, srs_flip_kicks>(6);
+    }
+}
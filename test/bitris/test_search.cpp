@@ -0,0 +1,261 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "search.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class SearchTest : public ::testing::Test {
+    };
+
+    template<typename Data>
+    std::vector<typename data<Data>::AlignedBoard> boards() {
+        return {
+                to_aligned<Data>(""),
+                to_aligned<Data>(lemontea),
+                to_aligned<Data>(
+                        ""
+                        "..XX......"
+                        ".....XX..."
+                        "X..X....XX"
+                        "XX...X.XXX"
+                        "X.XXXXXXXX"
+                ),
+        };
+    }
+
+    template<typename Data, Shape Shape>
+    void expect_batch_equal_to_search() {
+        using searcher = s::searcher<Data, Shape>;
+
+        // 盤面の数がBatchLanesで割り切れない場合や、向きが混ざる場合も含める
+        std::vector<typename data<Data>::AlignedBoard> all_boards;
+        std::vector<s::Spawn> spawns;
+        for (const auto &board: boards<Data>()) {
+            for (const auto orientation: {Orientation::North, Orientation::North, Orientation::East}) {
+                all_boards.push_back(board);
+                spawns.push_back({orientation, 4, 6});
+            }
+        }
+
+        std::vector<std::array<Data, searcher::N * 10> > out(all_boards.size());
+        searcher::search_batch(all_boards, spawns, out);
+
+        for (size_t index = 0; index < all_boards.size(); ++index) {
+            const auto &spawn = spawns[index];
+            const auto expected = searcher::search(all_boards[index], spawn.orientation, spawn.cx, spawn.cy);
+            EXPECT_EQ(out[index], expected) << "index=" << index;
+        }
+    }
+
+    TEST_F(SearchTest, search_batch_u8) {
+        using Data = uint8_t;
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_batch_equal_to_search<Data, Shape>();
+        });
+    }
+
+    TEST_F(SearchTest, search_batch_u32) {
+        using Data = uint32_t;
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_batch_equal_to_search<Data, Shape>();
+        });
+    }
+
+    template<typename Data>
+    void expect_all_shapes_equal_to_search() {
+        for (const auto &board: boards<Data>()) {
+            const auto results = s::search_all_shapes<Data>(board, Orientation::North, 4, 6);
+
+            static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+                using searcher = s::searcher<Data, Shape>;
+                const auto expected = searcher::search(board, Orientation::North, 4, 6);
+                const auto &actual = results[static_cast<size_t>(Shape)];
+                for (size_t index = 0; index < actual.size(); ++index) {
+                    EXPECT_EQ(actual[index], index < expected.size() ? expected[index] : 0);
+                }
+            });
+        }
+    }
+
+    TEST_F(SearchTest, search_all_shapes_u8) {
+        expect_all_shapes_equal_to_search<uint8_t>();
+    }
+
+    TEST_F(SearchTest, search_all_shapes_u32) {
+        expect_all_shapes_equal_to_search<uint32_t>();
+    }
+
+    template<typename Data, Shape Shape>
+    void expect_canonical_equal_to_fold() {
+        for (const auto &board: boards<Data>()) {
+            const auto board_t = data<Data>::load(board);
+            const auto expected = canonical<Data, Shape>::fold(
+                    s::searcher<Data, Shape>::execute(board_t, Orientation::North, 4, 6)
+            );
+            const auto actual = s::searcher<Data, Shape, true>::execute(board_t, Orientation::North, 4, 6);
+            for (size_t index = 0; index < actual.size(); ++index) {
+                EXPECT_TRUE(data<Data>::is_equal_to(actual[index], expected[index]));
+            }
+        }
+    }
+
+    TEST_F(SearchTest, search_canonical_u16) {
+        using Data = uint16_t;
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            expect_canonical_equal_to_fold<Data, Shape>();
+        });
+
+        // S, Z, IはSouth/Westが空になる
+        const auto board = data<Data>::load(boards<Data>()[1]);
+        static_for_t<{Shape::I, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            const auto goals = s::searcher<Data, Shape, true>::execute(board, Orientation::North, 4, 6);
+            EXPECT_TRUE(data<Data>::is_equal_to(goals[static_cast<size_t>(Orientation::South)], 0));
+            EXPECT_TRUE(data<Data>::is_equal_to(goals[static_cast<size_t>(Orientation::West)], 0));
+        });
+    }
+
+    TEST_F(SearchTest, search_hard_drop_empty_u8) {
+        using Data = uint8_t;
+        const auto board = data<Data>::make_zero();
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            const auto expected = s::searcher<Data, Shape>::execute(board, Orientation::North, 4, 20);
+            const auto actual = s::searcher<Data, Shape, false, Movement::HardDrop>::execute(
+                    board, Orientation::North, 4, 20
+            );
+            for (size_t index = 0; index < actual.size(); ++index) {
+                EXPECT_TRUE(data<Data>::is_equal_to(actual[index], expected[index]));
+            }
+        });
+    }
+
+    TEST_F(SearchTest, search_hard_drop_subset_u16) {
+        using Data = uint16_t;
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            for (const auto &aligned: boards<Data>()) {
+                const auto board = data<Data>::load(aligned);
+                const auto srs = s::searcher<Data, Shape>::execute(board, Orientation::North, 4, 10);
+                const auto hard_drop = s::searcher<Data, Shape, false, Movement::HardDrop>::execute(
+                        board, Orientation::North, 4, 10
+                );
+                for (size_t index = 0; index < hard_drop.size(); ++index) {
+                    EXPECT_TRUE(data<Data>::is_equal_to(hard_drop[index] & ~srs[index], 0));
+                }
+            }
+        });
+    }
+
+    TEST_F(SearchTest, search_hard_drop_t) {
+        using Data = uint16_t;
+        const auto board = data<Data>::from_str(
+                ""
+                "XX........"
+                "X........."
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        ).value();
+        const auto goals = s::searcher<Data, Shape::T, false, Movement::HardDrop>::execute(
+                board, Orientation::North, 4, 10
+        );
+
+        // 屋根の下のT-Spinの位置には届かない
+        constexpr auto south = static_cast<size_t>(Orientation::South);
+        EXPECT_EQ(goals[south][4] & (bits<Data>::one << 1), 0);
+
+        // 屋根のない列は、積まれたブロックの上に落ちる
+        constexpr auto north = static_cast<size_t>(Orientation::North);
+        EXPECT_EQ(goals[north][2], bits<Data>::one << 5);
+        EXPECT_EQ(goals[north][5], bits<Data>::one << 3);
+        EXPECT_EQ(goals[north][7], bits<Data>::one << 3);
+    }
+
+    TEST_F(SearchTest, search_narrowed_u64) {
+        using Data = uint64_t;
+        auto all_boards = boards<Data>();
+
+        // 高さ30段の盤面は、uint64_tのまま探索される
+        auto tall = all_boards[1];
+        for (auto &column: tall.columns) {
+            column |= (column << 15) | (column << 23);
+        }
+        all_boards.push_back(tall);
+
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            using searcher = s::searcher<Data, Shape>;
+            for (const auto &board: all_boards) {
+                for (const uint8_t spawn_cy: {2, 6, 12, 20, 40}) {
+                    const auto expected = searcher::search(board, Orientation::North, 4, spawn_cy);
+                    const auto actual = searcher::search_narrowed(board, Orientation::North, 4, spawn_cy);
+                    EXPECT_EQ(actual, expected) << "spawn_cy=" << static_cast<int>(spawn_cy);
+                }
+            }
+        });
+    }
+
+    TEST_F(SearchTest, search_u128_same_as_u64) {
+        const auto str = std::string(
+                ""
+                "XXXX..XXX."
+                "XXXXX.XXXX"
+                "......X..X"
+                ".........."
+                "...X......"
+                "....XX.X.X"
+                "XXX.X....."
+                "XX..X....X"
+                "X....X...."
+                "XX..XXXX.X"
+                "X....XX..."
+                "XX.XXX...."
+                ".......X.."
+                "......XXX."
+                "XX.X......"
+                "X....X...."
+                "X...X....X"
+                "X..XX.X.XX"
+                "XX..XXXXXX"
+        );
+        const auto board64 = to_aligned<uint64_t>(str);
+        const auto board128 = to_aligned<uint128_t>(str);
+
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            const auto expected = s::searcher<uint64_t, Shape>::search(board64, Orientation::North, 4, 20);
+            const auto actual = s::searcher<uint128_t, Shape>::search(board128, Orientation::North, 4, 20);
+            for (size_t index = 0; index < actual.size(); ++index) {
+                EXPECT_TRUE(actual[index] == expected[index]);
+            }
+        });
+    }
+
+    TEST_F(SearchTest, search_u128_above_64_rows) {
+        using Data = uint128_t;
+        auto aligned = typename data<Data>::AlignedBoard{};
+        for (size_t x = 0; x < 10; ++x) {
+            aligned.columns[x] = x == 4 ? 0 : bits<Data>::full >> 30;
+        }
+
+        // 98段の井戸の底までIが届く
+        const auto goals = s::searcher<Data, Shape::I>::search(aligned, Orientation::North, 4, 120);
+        constexpr auto west = static_cast<size_t>(Orientation::West);
+        EXPECT_TRUE(goals[west * 10 + 4] == 0b10);
+    }
+
+    TEST_F(SearchTest, search_blocked_spawn) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XX..XX..XX"
+                "XX..XX..XX"
+                "XX..XX..XX"
+        );
+
+        // spawnの行が途切れていて、spawnの位置が埋まっている場合は、どこにも置けない
+        static_for_t<{Shape::T, Shape::I, Shape::O, Shape::L, Shape::J, Shape::S, Shape::Z}>([&]<Shape Shape>() {
+            const auto goals = s::searcher<Data, Shape>::search(board, Orientation::North, 5, 1);
+            for (const auto goal: goals) {
+                EXPECT_EQ(goal, 0);
+            }
+        });
+    }
+}
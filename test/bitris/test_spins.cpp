@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include "search.hpp"
+#include "path.hpp"
+#include "corpus.hpp"
+#include "boards.hpp"
+
+namespace core {
+    class SpinsTest : public ::testing::Test {
+    };
+
+    template<typename Data>
+    bool contains(const std::array<Data, 4 * 10> &planes, const Placement &placement) {
+        return (planes[static_cast<size_t>(placement.orientation) * 10 + placement.x] >> placement.y) & 1;
+    }
+
+    // path_finderで到達できる位置を求め、1マスずつスピンを判定して比べる
+    template<typename Data>
+    void expect_same_as_scalar(const typename data<Data>::AlignedBoard &aligned) {
+        using bits_t = bits<Data>;
+        constexpr auto N = 4;
+
+        const auto board = data<Data>::load(aligned);
+        const auto spins = s::searcher<Data, Shape::T>::search_spins(aligned, Orientation::North, 4, 10);
+        const auto layers = path_finder<Data, Shape::T>::execute(board, Orientation::North, 4, 10);
+
+        std::array<typename data<Data>::type, N> reachable{};
+        for (const auto &generation: layers.generations) {
+            for (size_t index = 0; index < N; ++index) {
+                reachable[index] |= generation[index];
+            }
+        }
+
+        const auto is_free = [&](const size_t index, const int x, const int y) {
+            if (x < 0 || 10 <= x || y < 0 || static_cast<int>(bits_t::bit_size) <= y) {
+                return false;
+            }
+            return (layers.all_free_space[index][x] & (bits_t::one << y)) != 0;
+        };
+        const auto is_reachable = [&](const size_t index, const int x, const int y) {
+            return is_free(index, x, y) && (reachable[index][x] & (bits_t::one << y)) != 0;
+        };
+        const auto is_filled = [&](const int x, const int y) {
+            if (x < 0 || 10 <= x || y < 0) {
+                return true;
+            }
+            return y < static_cast<int>(bits_t::bit_size) && ((aligned.columns[x] >> y) & 1) != 0;
+        };
+
+        for (const auto &goal: placements<Data, Shape::T>::template extract<false>(spins.goals)) {
+            const auto index = static_cast<size_t>(goal.orientation);
+            const int x = goal.x;
+            const int y = goal.y;
+
+            // 回転で到達できるか。Tの最後のキックを使ったかも調べる
+            bool rotated = false;
+            bool last_kick = false;
+            static_for_t<{Orientation::North, Orientation::East, Orientation::South, Orientation::West}>(
+                    [&]<Orientation From>() {
+                        static_for_t<{Rotation::Cw, Rotation::Ccw}>([&]<Rotation R>() {
+                            if (rotate_to(From, R) != goal.orientation) {
+                                return;
+                            }
+                            constexpr auto offsets = get_offsets<{Shape::T, From}, R>();
+                            for (size_t k = 0; k < offsets.size(); ++k) {
+                                const auto sx = x - offsets[k].x;
+                                const auto sy = y - offsets[k].y;
+                                if (!is_reachable(static_cast<size_t>(From), sx, sy) ||
+                                    static_cast<int>(bits_t::bit_size) - 2 <= sy) {
+                                    continue;
+                                }
+                                bool is_first_kick = true;
+                                for (size_t j = 0; j < k; ++j) {
+                                    is_first_kick &= !is_free(index, sx + offsets[j].x, sy + offsets[j].y);
+                                }
+                                if (is_first_kick) {
+                                    rotated = true;
+                                    last_kick |= k == 4;
+                                }
+                            }
+                        });
+                    });
+
+            const bool immobile = !is_free(index, x - 1, y) && !is_free(index, x + 1, y) &&
+                                  !(is_free(index, x, y + 1) || static_cast<int>(bits_t::bit_size) - 1 <= y);
+
+            // North, East, South, Westの凸側のコーナー
+            const bool ne = is_filled(x + 1, y + 1);
+            const bool nw = is_filled(x - 1, y + 1);
+            const bool se = is_filled(x + 1, y - 1);
+            const bool sw = is_filled(x - 1, y - 1);
+            const std::array front{ne && nw, ne && se, se && sw, nw && sw};
+            const bool three_corners = 3 <= ne + nw + se + sw;
+            const bool tspin = rotated && three_corners && (front[index] || last_kick);
+            const bool mini = rotated && three_corners && !tspin;
+
+            EXPECT_EQ(contains(spins.rotated, goal), rotated) << x << "," << y << "," << index;
+            EXPECT_EQ(contains(spins.immobile, goal), immobile) << x << "," << y << "," << index;
+            EXPECT_EQ(contains(spins.tspin, goal), tspin) << x << "," << y << "," << index;
+            EXPECT_EQ(contains(spins.tspin_mini, goal), mini) << x << "," << y << "," << index;
+        }
+    }
+
+    TEST_F(SpinsTest, tspin_double) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XX........"
+                "X........."
+                "XXXX..XXXX"
+                "XXX...XXXX"
+                "XXXX.XXXXX"
+        );
+
+        const auto spins = s::searcher<Data, Shape::T>::search_spins(board, Orientation::North, 4, 10);
+        const auto goal = Placement{Orientation::South, 4, 1};
+        EXPECT_TRUE(contains(spins.goals, goal));
+        EXPECT_TRUE(contains(spins.rotated, goal));
+        EXPECT_TRUE(contains(spins.immobile, goal));
+        EXPECT_TRUE(contains(spins.tspin, goal));
+        EXPECT_FALSE(contains(spins.tspin_mini, goal));
+
+        // 上から落とした位置はスピンにならない
+        const auto dropped = Placement{Orientation::North, 4, 3};
+        EXPECT_TRUE(contains(spins.goals, dropped));
+        EXPECT_FALSE(contains(spins.tspin, dropped));
+        EXPECT_FALSE(contains(spins.tspin_mini, dropped));
+
+        expect_same_as_scalar<Data>(board);
+    }
+
+    TEST_F(SpinsTest, tspin_mini) {
+        using Data = uint8_t;
+        const auto board = to_aligned<Data>(
+                ""
+                ".X........"
+        );
+
+        // Tを左の壁に回し入れると、凸側のコーナーが1つだけ埋まる
+        const auto spins = s::searcher<Data, Shape::T>::search_spins(board, Orientation::North, 4, 6);
+        const auto goal = Placement{Orientation::East, 0, 1};
+        EXPECT_TRUE(contains(spins.goals, goal));
+        EXPECT_TRUE(contains(spins.rotated, goal));
+        EXPECT_TRUE(contains(spins.tspin_mini, goal));
+        EXPECT_FALSE(contains(spins.tspin, goal));
+
+        expect_same_as_scalar<Data>(board);
+    }
+
+    TEST_F(SpinsTest, empty) {
+        using Data = uint8_t;
+        const typename data<Data>::AlignedBoard board{};
+        const auto spins = s::searcher<Data, Shape::T>::search_spins(board, Orientation::North, 4, 6);
+
+        for (size_t index = 0; index < spins.goals.size(); ++index) {
+            EXPECT_EQ(spins.rotated[index] & ~spins.goals[index], 0);
+            EXPECT_EQ(spins.tspin[index], 0);
+            EXPECT_EQ(spins.tspin_mini[index], 0);
+        }
+    }
+
+    TEST_F(SpinsTest, other_shapes) {
+        using Data = uint16_t;
+        const auto board = to_aligned<Data>(
+                ""
+                "XXXX...XXX"
+                "XXX..XXXXX"
+        );
+
+        // Sを回し入れた位置は、動かせないためall-spinになる
+        const auto spins = s::searcher<Data, Shape::S>::search_spins(board, Orientation::North, 4, 10);
+        const auto goal = Placement{Orientation::South, 4, 1};
+        EXPECT_TRUE(contains(spins.goals, goal));
+        EXPECT_TRUE(contains(spins.rotated, goal));
+        EXPECT_TRUE(contains(spins.immobile, goal));
+        for (size_t index = 0; index < spins.goals.size(); ++index) {
+            EXPECT_EQ(spins.tspin[index], 0);
+            EXPECT_EQ(spins.tspin_mini[index], 0);
+        }
+
+        // Oは回転しない
+        const auto o = s::searcher<Data, Shape::O>::search_spins(board, Orientation::North, 4, 10);
+        for (const auto rotated: o.rotated) {
+            EXPECT_EQ(rotated, 0);
+        }
+    }
+
+    TEST_F(SpinsTest, corpus) {
+        auto generator = s::corpus_generator{25};
+        constexpr std::array<uint8_t, 3> heights{4, 8, 10};
+        for (const auto &corpus_board: generator.generate(8, heights)) {
+            if (const auto board = corpus_board.template to_aligned<uint16_t>()) {
+                expect_same_as_scalar<uint16_t>(*board);
+            }
+        }
+    }
+}